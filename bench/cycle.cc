@@ -0,0 +1,262 @@
+#include <kranewl/cycle.t.hh>
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <unistd.h>
+}
+
+typedef struct Element final {
+    std::size_t value;
+}* Element_ptr;
+
+static const std::vector<std::size_t> element_counts = {
+    4, 16, 64, 256, 1024, 4096
+};
+
+static volatile std::size_t sink = 0;
+
+template <bool Indexed>
+static Cycle<Element_ptr, Indexed>
+make_cycle(std::vector<Element_ptr> const& elements, std::size_t count)
+{
+    Cycle<Element_ptr, Indexed> cycle{{}, true};
+
+    for (std::size_t i = 0; i < count; ++i)
+        cycle.insert_at_back(elements[i]);
+
+    return cycle;
+}
+
+template <typename Function>
+static double
+measure(std::size_t iterations, Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < iterations; ++i)
+        function(i);
+
+    auto stop = std::chrono::steady_clock::now();
+
+    return static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()
+    ) / iterations;
+}
+
+template <bool Indexed>
+static std::vector<double>
+run_operations(
+    std::vector<Element_ptr> const& elements,
+    std::vector<std::size_t> const& lookups,
+    std::size_t count
+)
+{
+    std::vector<double> results = {};
+    std::size_t iterations = std::max<std::size_t>(2000, 400000 / count);
+
+    Cycle<Element_ptr, Indexed> cycle = make_cycle<Indexed>(elements, count);
+
+    // lookups index into twice the population, so half of them miss
+    results.push_back(measure(iterations, [&](std::size_t i) {
+        sink = sink + cycle.contains(elements[lookups[i % lookups.size()] % (2 * count)]);
+    }));
+
+    results.push_back(measure(iterations, [&](std::size_t i) {
+        sink = sink + cycle.index_of_element(elements[lookups[i % lookups.size()] % count])
+            .value_or(0);
+    }));
+
+    results.push_back(measure(iterations, [&](std::size_t i) {
+        cycle.activate_element(elements[lookups[i % lookups.size()] % count]);
+        sink = sink + cycle.active_index();
+    }));
+
+    results.push_back(measure(iterations, [&](std::size_t i) {
+        Element_ptr element = elements[lookups[i % lookups.size()] % count];
+        cycle.remove_element(element);
+        cycle.insert_at_back(element);
+        sink = sink + cycle.active_index();
+    }));
+
+    results.push_back(measure(iterations, [&](std::size_t i) {
+        cycle.cycle_active(i % 2 ? Direction::Forward : Direction::Backward);
+        sink = sink + cycle.active_index();
+    }));
+
+    return results;
+}
+
+static const std::vector<std::string> operation_names = {
+    "contains",
+    "index_of_element",
+    "activate_element",
+    "remove+insert",
+    "cycle_active",
+};
+
+static std::size_t
+verify(std::vector<Element_ptr> const& elements, std::size_t count, std::size_t steps)
+{
+    std::mt19937 rng(count);
+    std::uniform_int_distribution<std::size_t> pick(0, 2 * count - 1);
+    std::uniform_int_distribution<int> operation(0, 13);
+
+    Cycle<Element_ptr, false> linear = make_cycle<false>(elements, count);
+    Cycle<Element_ptr, true> indexed = make_cycle<true>(elements, count);
+
+    std::size_t mismatches = 0;
+
+    for (std::size_t step = 0; step < steps; ++step) {
+        Element_ptr element = elements[pick(rng)];
+        Element_ptr other = elements[pick(rng)];
+        Index index = pick(rng) % (linear.size() + 1);
+        Direction direction = pick(rng) % 2 ? Direction::Forward : Direction::Backward;
+
+        auto apply = [&](auto& cycle) {
+            switch (operation(rng)) {
+            case 0:
+            {
+                if (!cycle.contains(element))
+                    cycle.insert_at_back(element);
+
+                break;
+            }
+            case 1:
+            {
+                if (!cycle.contains(element))
+                    cycle.insert_at_front(element);
+
+                break;
+            }
+            case 2:
+            {
+                if (!cycle.contains(element))
+                    cycle.insert_before_index(index, element);
+
+                break;
+            }
+            case 3:
+            {
+                if (!cycle.contains(element))
+                    cycle.insert_after_element(other, element);
+
+                break;
+            }
+            case 4:  cycle.remove_element(element);                    break;
+            case 5:  cycle.remove_at_index(index);                     break;
+            case 6:  cycle.remove_first();                             break;
+            case 7:  cycle.activate_element(element);                  break;
+            case 8:  cycle.swap_elements(element, other);              break;
+            case 9:  cycle.replace_element(element, other);            break;
+            case 10: cycle.rotate(direction);                          break;
+            case 11: cycle.rotate_range(direction, index / 2, index);  break;
+            case 12: cycle.drag_active(direction);                     break;
+            case 13: cycle.reverse();                                  break;
+            }
+        };
+
+        std::mt19937 rng_state = rng;
+        apply(linear);
+        rng = rng_state;
+        apply(indexed);
+
+        bool consistent = linear.as_deque() == indexed.as_deque()
+            && linear.active_index() == indexed.active_index()
+            && linear.stack() == indexed.stack()
+            && linear.contains(element) == indexed.contains(element)
+            && linear.index_of_element(other) == indexed.index_of_element(other);
+
+        if (!consistent) {
+            spdlog::error("Indexed cycle diverges at step {} ({} elements)", step, count);
+            ++mismatches;
+            break;
+        }
+    }
+
+    return mismatches;
+}
+
+static const std::string USAGE = "usage: cycle-bench [...options]\n\n"
+    "options: \n"
+    "  -m <max_elements> Only run cases with at most this many elements.\n"
+    "  -s <steps>        Number of randomized steps to cross-check per case.\n"
+    "  -h                Prints this message.";
+
+int
+main(int argc, char** argv)
+{
+    spdlog::set_level(spdlog::level::warn);
+
+    std::size_t max_elements = element_counts.back();
+    std::size_t steps = 20000;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "h?m:s:")) != -1) {
+        switch (opt) {
+        case 'm': max_elements = std::stoul(optarg); break;
+        case 's': steps = std::stoul(optarg);        break;
+        case '?':
+        case 'h':
+        default:
+            std::puts(USAGE.c_str());
+            return EXIT_SUCCESS;
+        }
+    }
+
+    std::vector<Element_ptr> elements = {};
+    for (std::size_t i = 0; i < 2 * element_counts.back(); ++i)
+        elements.push_back(new Element{i});
+
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<std::size_t> pick(0, 2 * element_counts.back() - 1);
+
+    std::vector<std::size_t> lookups = {};
+    for (std::size_t i = 0; i < 4096; ++i)
+        lookups.push_back(pick(rng));
+
+    std::size_t mismatches = 0;
+
+    std::printf(
+        "%-18s %8s %14s %14s %10s\n",
+        "operation", "elements", "linear ns/op", "indexed ns/op", "speedup"
+    );
+
+    for (std::size_t count : element_counts) {
+        if (count > max_elements)
+            break;
+
+        mismatches += verify(elements, count, steps);
+
+        std::vector<double> linear = run_operations<false>(elements, lookups, count);
+        std::vector<double> indexed = run_operations<true>(elements, lookups, count);
+
+        for (std::size_t i = 0; i < operation_names.size(); ++i)
+            std::printf(
+                "%-18s %8zu %14.1f %14.1f %9.2fx\n",
+                operation_names[i].c_str(),
+                count,
+                linear[i],
+                indexed[i],
+                linear[i] / indexed[i]
+            );
+    }
+
+    for (Element_ptr element : elements)
+        delete element;
+
+    if (mismatches) {
+        spdlog::error("{} cases diverge from the linear implementation", mismatches);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,418 @@
+#include <kranewl/layout.hh>
+
+#include <kranewl/context.hh>
+#include <kranewl/cycle.t.hh>
+#include <kranewl/geometry.hh>
+#include <kranewl/placement.hh>
+#include <kranewl/tree/view.hh>
+#include <kranewl/workspace.hh>
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <new>
+#include <string>
+#include <tuple>
+#include <vector>
+
+extern "C" {
+#include <unistd.h>
+}
+
+static std::size_t allocations = 0;
+
+void*
+operator new(std::size_t size)
+{
+    ++allocations;
+
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc{};
+}
+
+void*
+operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void
+operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void
+operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void
+operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+typedef struct BenchView final : public View {
+    BenchView(Uid uid)
+        : View(
+              static_cast<XDGView_ptr>(nullptr),
+              uid,
+              nullptr,
+              nullptr,
+              nullptr,
+              nullptr
+          )
+    {
+        set_scene_layer(SCENE_LAYER_TILE);
+    }
+
+    void format_uid() override {}
+
+    Region constraints() override { return Region{}; }
+    pid_t retrieve_pid() override { return 0; }
+    bool prefers_floating() override { return false; }
+
+    void focus(Toggle) override {}
+    void activate(Toggle) override {}
+    void effectuate_fullscreen(bool) override {}
+
+    bool send_configure(Region const&, Extents const&) override { return false; }
+    void close() override {}
+    void close_popups() override {}
+
+}* BenchView_ptr;
+
+static const std::vector<std::pair<LayoutHandler::LayoutKind, std::string>> layout_kinds = {
+    { LayoutHandler::LayoutKind::Float,                  "Float" },
+    { LayoutHandler::LayoutKind::FramelessFloat,         "FramelessFloat" },
+    { LayoutHandler::LayoutKind::SingleFloat,            "SingleFloat" },
+    { LayoutHandler::LayoutKind::FramelessSingleFloat,   "FramelessSingleFloat" },
+    { LayoutHandler::LayoutKind::Center,                 "Center" },
+    { LayoutHandler::LayoutKind::Monocle,                "Monocle" },
+    { LayoutHandler::LayoutKind::MainDeck,               "MainDeck" },
+    { LayoutHandler::LayoutKind::StackDeck,              "StackDeck" },
+    { LayoutHandler::LayoutKind::DoubleDeck,             "DoubleDeck" },
+    { LayoutHandler::LayoutKind::Paper,                  "Paper" },
+    { LayoutHandler::LayoutKind::CompactPaper,           "CompactPaper" },
+    { LayoutHandler::LayoutKind::OverlappingPaper,       "OverlappingPaper" },
+    { LayoutHandler::LayoutKind::DoubleStack,            "DoubleStack" },
+    { LayoutHandler::LayoutKind::CompactDoubleStack,     "CompactDoubleStack" },
+    { LayoutHandler::LayoutKind::HorizontalStack,        "HorizontalStack" },
+    { LayoutHandler::LayoutKind::CompactHorizontalStack, "CompactHorizontalStack" },
+    { LayoutHandler::LayoutKind::VerticalStack,          "VerticalStack" },
+    { LayoutHandler::LayoutKind::CompactVerticalStack,   "CompactVerticalStack" },
+};
+
+enum class Setting {
+    Default,
+    Gap,
+    Margin,
+    MainCount,
+};
+
+static const std::vector<std::pair<Setting, std::string>> settings = {
+    { Setting::Default,   "default" },
+    { Setting::Gap,       "gap" },
+    { Setting::Margin,    "margin" },
+    { Setting::MainCount, "main_count" },
+};
+
+static const std::vector<std::size_t> view_counts = {
+    1, 2, 3, 5, 10, 30, 100, 1000, 10000
+};
+
+static const Region SCREEN_REGION = Region{
+    .pos = Pos{0, 0},
+    .dim = Dim{2560, 1440}
+};
+
+template <typename Arranger>
+static void
+apply_setting(Arranger& arranger, Setting setting)
+{
+    arranger.reset_layout_data();
+
+    switch (setting) {
+    case Setting::Default:   break;
+    case Setting::Gap:       arranger.change_gap_size(12);  break;
+    case Setting::Margin:    arranger.change_margin(40);    break;
+    case Setting::MainCount: arranger.change_main_count(2); break;
+    }
+}
+
+template <typename Function>
+static std::pair<double, double>
+measure(std::size_t iterations, Function function)
+{
+    std::size_t allocations_before = allocations;
+    auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < iterations; ++i)
+        function();
+
+    auto stop = std::chrono::steady_clock::now();
+    std::size_t allocations_after = allocations;
+
+    return {
+        static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()
+        ) / iterations,
+        static_cast<double>(allocations_after - allocations_before) / iterations
+    };
+}
+
+static std::uint64_t
+digest(std::vector<Placement> const& placements)
+{
+    std::uint64_t hash = 0xcbf29ce484222325;
+    auto mix = [&hash](std::int64_t value) {
+        for (std::size_t i = 0; i < sizeof(value); ++i) {
+            hash ^= static_cast<std::uint64_t>((value >> (i * 8)) & 0xff);
+            hash *= 0x100000001b3;
+        }
+    };
+
+    for (Placement const& placement : placements) {
+        mix(static_cast<std::int64_t>(placement.view->uid()));
+        mix(static_cast<std::int64_t>(placement.method));
+
+        Extents const& extents = placement.decoration.extents();
+        mix(extents.left);
+        mix(extents.right);
+        mix(extents.top);
+        mix(extents.bottom);
+
+        mix(placement.region.has_value());
+        if (placement.region) {
+            mix(placement.region->pos.x);
+            mix(placement.region->pos.y);
+            mix(placement.region->dim.w);
+            mix(placement.region->dim.h);
+        }
+    }
+
+    return hash;
+}
+
+typedef std::tuple<std::string, std::string, std::size_t> Case;
+
+static std::map<Case, std::uint64_t>
+read_golden(std::string const& golden_path)
+{
+    std::map<Case, std::uint64_t> golden = {};
+    std::ifstream golden_if(golden_path);
+
+    std::string kind, setting;
+    std::size_t count;
+    std::string hash;
+
+    while (golden_if >> kind >> setting >> count >> hash)
+        golden[{kind, setting, count}] = std::stoull(hash, nullptr, 16);
+
+    return golden;
+}
+
+static const std::string USAGE = "usage: layout-bench [...options]\n\n"
+    "options: \n"
+    "  -c <golden_file> Compare placements against a golden file.\n"
+    "  -r <golden_file> Record placements into a golden file.\n"
+    "  -m <max_views>   Only run cases with at most this many views.\n"
+    "  -h               Prints this message.";
+
+int
+main(int argc, char** argv)
+{
+    spdlog::set_level(spdlog::level::warn);
+
+    std::string check_path, record_path;
+    std::size_t max_views = view_counts.back();
+    int opt;
+
+    while ((opt = getopt(argc, argv, "h?c:r:m:")) != -1) {
+        switch (opt) {
+        case 'c': check_path = optarg;               break;
+        case 'r': record_path = optarg;              break;
+        case 'm': max_views = std::stoul(optarg);    break;
+        case '?':
+        case 'h':
+        default:
+            std::puts(USAGE.c_str());
+            return EXIT_SUCCESS;
+        }
+    }
+
+    std::map<Case, std::uint64_t> golden = {};
+    if (!check_path.empty())
+        golden = read_golden(check_path);
+
+    std::ofstream record_of;
+    if (!record_path.empty())
+        record_of.open(record_path);
+
+    std::vector<View_ptr> views = {};
+    for (std::size_t i = 0; i < view_counts.back(); ++i) {
+        BenchView_ptr view = new BenchView(i + 1);
+
+        view->set_free_region(Region{
+            .pos = Pos{
+                static_cast<int>((i * 37) % 2000),
+                static_cast<int>((i * 53) % 1100)
+            },
+            .dim = View::PREFERRED_INIT_VIEW_DIM
+        });
+
+        views.push_back(view);
+    }
+
+    views.front()->set_focused(true);
+
+    Context_ptr context = new Context(0, "bench");
+    std::vector<Workspace_ptr> workspaces = {};
+
+    for (std::size_t count : view_counts) {
+        Workspace_ptr workspace = new Workspace(workspaces.size(), "bench", context);
+
+        for (std::size_t i = 0; i < count; ++i)
+            workspace->add_view(views[i]);
+
+        workspaces.push_back(workspace);
+    }
+
+    LayoutHandler layout_handler{};
+    std::vector<Placement> placements = {};
+    placements.reserve(views.size());
+
+    std::size_t mismatches = 0;
+    std::size_t allocating_arranges = 0;
+
+    std::printf(
+        "%-24s %-12s %8s %14s %14s %14s %14s %16s\n",
+        "layout", "setting", "views",
+        "ns/arrange", "allocs/arrange",
+        "ns/workspace", "allocs/workspace",
+        "digest"
+    );
+
+    for (auto const& [kind, kind_name] : layout_kinds) {
+        layout_handler.set_kind(kind);
+
+        for (Workspace_ptr workspace : workspaces)
+            workspace->set_layout(kind);
+
+        for (auto const& [setting, setting_name] : settings) {
+            apply_setting(layout_handler, setting);
+
+            for (Workspace_ptr workspace : workspaces)
+                apply_setting(*workspace, setting);
+
+            for (std::size_t c = 0; c < view_counts.size(); ++c) {
+                std::size_t count = view_counts[c];
+                Workspace_ptr workspace = workspaces[c];
+
+                if (count > max_views)
+                    break;
+
+                auto begin = views.cbegin();
+                auto end = views.cbegin() + count;
+
+                placements.clear();
+                layout_handler.arrange(SCREEN_REGION, placements, begin, end);
+                std::uint64_t hash = digest(placements);
+
+                std::size_t iterations = std::max<std::size_t>(20, 200000 / count);
+
+                auto [ns, allocs] = measure(iterations, [&]() {
+                    placements.clear();
+                    layout_handler.arrange(SCREEN_REGION, placements, begin, end);
+                });
+
+                // the bench views are neither fullscreen nor floating, so the
+                // workspace hands all of them to its layout handler in order
+                std::uint64_t workspace_hash = digest(workspace->arrange(SCREEN_REGION));
+
+                auto [workspace_ns, workspace_allocs] = measure(iterations, [&]() {
+                    workspace->arrange(SCREEN_REGION);
+                });
+
+                std::printf(
+                    "%-24s %-12s %8zu %14.1f %14.2f %14.1f %14.2f %016llx\n",
+                    kind_name.c_str(),
+                    setting_name.c_str(),
+                    count,
+                    ns,
+                    allocs,
+                    workspace_ns,
+                    workspace_allocs,
+                    static_cast<unsigned long long>(hash)
+                );
+
+                if (workspace_allocs > 0.)
+                    ++allocating_arranges;
+
+                if (record_of.is_open())
+                    record_of << kind_name << " " << setting_name << " " << count
+                        << " " << std::hex << hash << std::dec << "\n";
+
+                if (!check_path.empty()) {
+                    auto expected = golden.find({kind_name, setting_name, count});
+
+                    if (expected == golden.end() || expected->second != hash) {
+                        spdlog::error(
+                            "Placements of {} ({}, {} views) diverge from golden output",
+                            kind_name,
+                            setting_name,
+                            count
+                        );
+
+                        ++mismatches;
+                    }
+
+                    if (expected == golden.end() || expected->second != workspace_hash) {
+                        spdlog::error(
+                            "Workspace placements of {} ({}, {} views) diverge from golden output",
+                            kind_name,
+                            setting_name,
+                            count
+                        );
+
+                        ++mismatches;
+                    }
+                }
+            }
+        }
+    }
+
+    for (Workspace_ptr workspace : workspaces)
+        delete workspace;
+
+    delete context;
+
+    for (View_ptr view : views)
+        delete view;
+
+    if (allocating_arranges)
+        spdlog::error("{} cases allocate in steady-state Workspace::arrange", allocating_arranges);
+
+    if (mismatches)
+        spdlog::error("{} cases diverge from golden output", mismatches);
+
+    if (allocating_arranges || mismatches)
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
@@ -2,11 +2,14 @@
 
 #include <kranewl/common.hh>
 #include <kranewl/cycle.hh>
+#include <kranewl/scene-layer.hh>
 
+#include <algorithm>
+#include <array>
 #include <string>
-#include <unordered_set>
+#include <vector>
 
-typedef class Client* Client_ptr;
+typedef struct View* View_ptr;
 typedef class Workspace* Workspace_ptr;
 typedef class Output* Output_ptr;
 typedef class Context final {
@@ -18,7 +21,10 @@ public:
           mp_active(nullptr),
           mp_prev_active(nullptr),
           m_workspaces({}, true),
-          m_focus_follows_cursor(true)
+          m_sticky_views({}),
+          m_focus_follows_cursor(true),
+          m_scene_layers({}),
+          m_scene_enabled(false)
     {}
 
     Index
@@ -61,6 +67,7 @@ public:
     set_output(Output_ptr output)
     {
         mp_output = output;
+        set_scene_enabled(output != nullptr);
     }
 
     void
@@ -98,23 +105,34 @@ public:
     }
 
     void
-    register_sticky_client(Client_ptr client)
+    register_sticky_view(View_ptr view)
     {
-        m_sticky_clients.insert(client);
+        if (std::find(m_sticky_views.begin(), m_sticky_views.end(), view)
+            == m_sticky_views.end())
+        {
+            m_sticky_views.push_back(view);
+        }
     }
 
     void
-    unregister_sticky_client(Client_ptr client)
+    unregister_sticky_view(View_ptr view)
     {
-        m_sticky_clients.erase(client);
+        m_sticky_views.erase(
+            std::remove(m_sticky_views.begin(), m_sticky_views.end(), view),
+            m_sticky_views.end()
+        );
     }
 
-    std::unordered_set<Client_ptr> const&
-    sticky_clients() const
+    std::vector<View_ptr> const&
+    sticky_views() const
     {
-        return m_sticky_clients;
+        return m_sticky_views;
     }
 
+    void create_scene_layers(std::array<struct wlr_scene_node*, 8> const&);
+    struct wlr_scene_node* scene_layer(SceneLayer) const;
+    void set_scene_enabled(bool);
+
     bool
     focus_follows_cursor() const
     {
@@ -185,8 +203,11 @@ private:
     Workspace_ptr mp_prev_active;
 
     Cycle<Workspace_ptr> m_workspaces;
-    std::unordered_set<Client_ptr> m_sticky_clients;
+    std::vector<View_ptr> m_sticky_views;
 
     bool m_focus_follows_cursor;
 
+    std::array<struct wlr_scene_node*, 8> m_scene_layers;
+    bool m_scene_enabled;
+
 }* Context_ptr;
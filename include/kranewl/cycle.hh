@@ -38,7 +38,7 @@ private:
 
 };
 
-template <typename T>
+template <typename T, bool Indexed = true>
 class Cycle final {
     static_assert(std::is_pointer<T>::value,
         "Only pointer types may be stored in a cycle.");
@@ -328,8 +328,8 @@ public:
         }
         }
 
-        if (m_index != *index && m_index < m_elements.size() && *index < m_elements.size())
-            std::iter_swap(m_elements.begin() + m_index, m_elements.begin() + *index);
+        if (m_index != *index)
+            swap_indices(m_index, *index);
 
         return cycle_active_with_condition(direction, predicate, wraps);
     }
@@ -400,13 +400,34 @@ private:
     void push_active_to_stack();
     std::optional<T> get_active_from_stack();
 
+    void index_element(T, Index);
+    void unindex_element(T);
+    void shift_indices(Index, int);
+    void invalidate_indices();
+    std::optional<Index> lookup_index(T) const;
+    void reindex() const;
+
     Index m_index;
     std::deque<T> m_elements;
 
     bool m_unwindable;
     HistoryStack<T> m_stack;
 
+    static constexpr std::size_t MIN_INDEXED_SIZE = 32;
+    static constexpr std::size_t MAX_INDEX_SHIFTS = 32;
+
+    struct IndexShift final {
+        Index index;
+        int delta;
+    };
+
+    mutable std::unordered_map<T, std::pair<Index, std::size_t>> m_indices;
+    mutable std::vector<IndexShift> m_index_shifts;
+    mutable std::size_t m_index_epoch;
+    mutable bool m_indices_stale;
+    bool m_indexing;
+
 };
 
-template<typename T>
-using Cycle_ptr = Cycle<T>*;
+template<typename T, bool Indexed = true>
+using Cycle_ptr = Cycle<T, Indexed>*;
@@ -74,35 +74,57 @@ HistoryStack<T>::as_vector() const
 }
 
 
-template <typename T>
-Cycle<T>::Cycle(std::vector<T> elements, bool unwindable)
+template <typename T, bool Indexed>
+Cycle<T, Indexed>::Cycle(std::vector<T> elements, bool unwindable)
     : m_index(Util::last_index(elements)),
       m_elements({}),
       m_unwindable(unwindable),
-      m_stack(HistoryStack<T>())
+      m_stack(HistoryStack<T>()),
+      m_indices({}),
+      m_index_shifts({}),
+      m_index_epoch(0),
+      m_indices_stale(false),
+      m_indexing(false)
 {
     m_elements.resize(elements.size());
     std::copy(elements.begin(), elements.end(), m_elements.begin());
+
+    if constexpr (Indexed)
+        if (m_elements.size() > MIN_INDEXED_SIZE) {
+            m_indexing = true;
+            reindex();
+        }
 }
 
-template <typename T>
-Cycle<T>::Cycle(std::initializer_list<T> elements, bool unwindable)
+template <typename T, bool Indexed>
+Cycle<T, Indexed>::Cycle(std::initializer_list<T> elements, bool unwindable)
     : m_index(0),
       m_elements({}),
       m_unwindable(unwindable),
-      m_stack(HistoryStack<T>())
+      m_stack(HistoryStack<T>()),
+      m_indices({}),
+      m_index_shifts({}),
+      m_index_epoch(0),
+      m_indices_stale(false),
+      m_indexing(false)
 {
     std::copy(elements.begin(), elements.end(), m_elements.begin());
     m_index = Util::last_index(m_elements);
+
+    if constexpr (Indexed)
+        if (m_elements.size() > MIN_INDEXED_SIZE) {
+            m_indexing = true;
+            reindex();
+        }
 }
 
-template <typename T>
-Cycle<T>::~Cycle()
+template <typename T, bool Indexed>
+Cycle<T, Indexed>::~Cycle()
 {}
 
-template <typename T>
+template <typename T, bool Indexed>
 bool
-Cycle<T>::next_will_wrap(Direction direction) const
+Cycle<T, Indexed>::next_will_wrap(Direction direction) const
 {
     switch (direction) {
     case Direction::Backward: return m_index == 0;
@@ -112,55 +134,63 @@ Cycle<T>::next_will_wrap(Direction direction) const
     return false;
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 bool
-Cycle<T>::empty() const
+Cycle<T, Indexed>::empty() const
 {
     return m_elements.empty();
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 bool
-Cycle<T>::contains(T element) const
+Cycle<T, Indexed>::contains(T element) const
 {
+    if constexpr (Indexed)
+        if (m_indexing) {
+            if (m_indices_stale)
+                reindex();
+
+            return m_indices.contains(element);
+        }
+
     return Util::contains(m_elements, element);
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 bool
-Cycle<T>::is_active_element(T element) const
+Cycle<T, Indexed>::is_active_element(T element) const
 {
     std::optional<Index> current = this->index();
     return current && *current == index_of_element(element);
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 bool
-Cycle<T>::is_active_index(Index index) const
+Cycle<T, Indexed>::is_active_index(Index index) const
 {
     std::optional<Index> current = this->index();
     return current && *current == index;
 }
 
 
-template <typename T>
+template <typename T, bool Indexed>
 std::size_t
-Cycle<T>::size() const
+Cycle<T, Indexed>::size() const
 {
     return m_elements.size();
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 std::size_t
-Cycle<T>::length() const
+Cycle<T, Indexed>::length() const
 {
     return m_elements.size();
 }
 
 
-template <typename T>
+template <typename T, bool Indexed>
 std::optional<Index>
-Cycle<T>::index() const
+Cycle<T, Indexed>::index() const
 {
     if (m_index < m_elements.size())
         return m_index;
@@ -168,30 +198,30 @@ Cycle<T>::index() const
     return std::nullopt;
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 Index
-Cycle<T>::active_index() const
+Cycle<T, Indexed>::active_index() const
 {
     return m_index;
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 Index
-Cycle<T>::last_index() const
+Cycle<T, Indexed>::last_index() const
 {
     return Util::last_index(m_elements);
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 Index
-Cycle<T>::next_index(Direction direction) const
+Cycle<T, Indexed>::next_index(Direction direction) const
 {
     return next_index_from(m_index, direction);
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 Index
-Cycle<T>::next_index_from(Index index, Direction direction) const
+Cycle<T, Indexed>::next_index_from(Index index, Direction direction) const
 {
     Index end = Util::last_index(m_elements);
 
@@ -203,17 +233,21 @@ Cycle<T>::next_index_from(Index index, Direction direction) const
 }
 
 
-template <typename T>
+template <typename T, bool Indexed>
 std::optional<Index>
-Cycle<T>::index_of_element(const T element) const
+Cycle<T, Indexed>::index_of_element(const T element) const
 {
+    if constexpr (Indexed)
+        if (m_indexing)
+            return lookup_index(element);
+
     return Util::index_of(m_elements, element);
 }
 
 
-template <typename T>
+template <typename T, bool Indexed>
 std::optional<T>
-Cycle<T>::next_element(Direction direction) const
+Cycle<T, Indexed>::next_element(Direction direction) const
 {
     std::optional<Index> index = next_index(direction);
     if (index && *index < m_elements.size())
@@ -222,9 +256,9 @@ Cycle<T>::next_element(Direction direction) const
     return std::nullopt;
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 std::optional<T>
-Cycle<T>::active_element() const
+Cycle<T, Indexed>::active_element() const
 {
     if (m_index < m_elements.size())
         return m_elements[m_index];
@@ -232,16 +266,16 @@ Cycle<T>::active_element() const
     return std::nullopt;
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 std::optional<T>
-Cycle<T>::prev_active_element() const
+Cycle<T, Indexed>::prev_active_element() const
 {
     return m_stack.peek_back();
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 std::optional<T>
-Cycle<T>::element_at_index(Index index) const
+Cycle<T, Indexed>::element_at_index(Index index) const
 {
     if (index < m_elements.size())
         return m_elements[index];
@@ -249,9 +283,9 @@ Cycle<T>::element_at_index(Index index) const
     return std::nullopt;
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 std::optional<T>
-Cycle<T>::element_at_front(T) const
+Cycle<T, Indexed>::element_at_front(T) const
 {
     if (!m_elements.empty())
         return m_elements[0];
@@ -259,9 +293,9 @@ Cycle<T>::element_at_front(T) const
     return std::nullopt;
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 std::optional<T>
-Cycle<T>::element_at_back(T) const
+Cycle<T, Indexed>::element_at_back(T) const
 {
     if (!m_elements.empty())
         return m_elements[Util::last_index(m_elements)];
@@ -270,23 +304,23 @@ Cycle<T>::element_at_back(T) const
 }
 
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::activate_first()
+Cycle<T, Indexed>::activate_first()
 {
     activate_at_index(0);
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::activate_last()
+Cycle<T, Indexed>::activate_last()
 {
     activate_at_index(Util::last_index(m_elements));
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::activate_at_index(Index index)
+Cycle<T, Indexed>::activate_at_index(Index index)
 {
     if (index != m_index) {
         push_active_to_stack();
@@ -294,22 +328,27 @@ Cycle<T>::activate_at_index(Index index)
     }
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::activate_element(T element)
+Cycle<T, Indexed>::activate_element(T element)
 {
-    std::optional<Index> index = Util::index_of(m_elements, element);
+    std::optional<Index> index = index_of_element(element);
     if (index)
         activate_at_index(*index);
 }
 
 
-template <typename T>
+template <typename T, bool Indexed>
 bool
-Cycle<T>::remove_first()
+Cycle<T, Indexed>::remove_first()
 {
     bool must_resync = is_active_index(0);
 
+    if (!m_elements.empty()) {
+        unindex_element(m_elements.front());
+        shift_indices(0, -1);
+    }
+
     std::size_t size_before = m_elements.size();
     Util::erase_at_index(m_elements, 0);
 
@@ -319,13 +358,16 @@ Cycle<T>::remove_first()
     return size_before != m_elements.size();
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 bool
-Cycle<T>::remove_last()
+Cycle<T, Indexed>::remove_last()
 {
     Index end = Util::last_index(m_elements);
     bool must_resync = is_active_index(end);
 
+    if (!m_elements.empty())
+        unindex_element(m_elements.back());
+
     std::size_t size_before = m_elements.size();
     Util::erase_at_index(m_elements, end);
 
@@ -335,12 +377,17 @@ Cycle<T>::remove_last()
     return size_before != m_elements.size();
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 bool
-Cycle<T>::remove_at_index(Index index)
+Cycle<T, Indexed>::remove_at_index(Index index)
 {
     bool must_resync = is_active_index(index);
 
+    if (index < m_elements.size()) {
+        unindex_element(m_elements[index]);
+        shift_indices(index, -1);
+    }
+
     std::size_t size_before = m_elements.size();
     Util::erase_at_index(m_elements, index);
 
@@ -350,13 +397,18 @@ Cycle<T>::remove_at_index(Index index)
     return size_before != m_elements.size();
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 bool
-Cycle<T>::remove_element(T element)
+Cycle<T, Indexed>::remove_element(T element)
 {
     std::optional<Index> index = index_of_element(element);
     bool must_resync = is_active_element(element);
 
+    if (index) {
+        unindex_element(element);
+        shift_indices(*index, -1);
+    }
+
     std::size_t size_before = m_elements.size();
 
     Util::erase_remove(m_elements, element);
@@ -373,9 +425,9 @@ Cycle<T>::remove_element(T element)
 }
 
 
-template <typename T>
+template <typename T, bool Indexed>
 std::optional<T>
-Cycle<T>::pop_back()
+Cycle<T, Indexed>::pop_back()
 {
     std::optional<T> value = std::nullopt;
 
@@ -383,6 +435,7 @@ Cycle<T>::pop_back()
         bool must_resync = is_active_element(m_elements.back());
 
         value = std::optional(m_elements.back());
+        unindex_element(m_elements.back());
         m_elements.pop_back();
 
         if (must_resync)
@@ -393,9 +446,9 @@ Cycle<T>::pop_back()
 }
 
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::replace_element(T element, T replacement)
+Cycle<T, Indexed>::replace_element(T element, T replacement)
 {
     if (contains(replacement))
         return;
@@ -405,40 +458,52 @@ Cycle<T>::replace_element(T element, T replacement)
     if (index) {
         m_elements[*index] = replacement;
         m_stack.replace(element, replacement);
+
+        unindex_element(element);
+        index_element(replacement, *index);
     }
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::swap_elements(T element1, T element2)
+Cycle<T, Indexed>::swap_elements(T element1, T element2)
 {
     std::optional<Index> index1 = index_of_element(element1);
     std::optional<Index> index2 = index_of_element(element2);
 
     if (index1 && index2)
-        std::iter_swap(m_elements.begin() + *index1, m_elements.begin() + *index2);
+        swap_indices(*index1, *index2);
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::swap_indices(Index index1, Index index2)
+Cycle<T, Indexed>::swap_indices(Index index1, Index index2)
 {
-    if (index1 < m_elements.size() && index2 < m_elements.size())
+    if (index1 < m_elements.size() && index2 < m_elements.size()) {
         std::iter_swap(m_elements.begin() + index1, m_elements.begin() + index2);
+
+        unindex_element(m_elements[index1]);
+        unindex_element(m_elements[index2]);
+        index_element(m_elements[index1], index1);
+        index_element(m_elements[index2], index2);
+    }
 }
 
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::reverse()
+Cycle<T, Indexed>::reverse()
 {
     std::reverse(m_elements.begin(), m_elements.end());
+    invalidate_indices();
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::rotate(Direction direction)
+Cycle<T, Indexed>::rotate(Direction direction)
 {
+    invalidate_indices();
+
     switch (direction) {
     case Direction::Backward:
     {
@@ -464,13 +529,15 @@ Cycle<T>::rotate(Direction direction)
     }
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::rotate_range(Direction direction, Index begin, Index end)
+Cycle<T, Indexed>::rotate_range(Direction direction, Index begin, Index end)
 {
     if (begin >= end || begin >= m_elements.size() || end > m_elements.size())
         return;
 
+    invalidate_indices();
+
     switch (direction) {
     case Direction::Backward:
     {
@@ -496,9 +563,9 @@ Cycle<T>::rotate_range(Direction direction, Index begin, Index end)
     }
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 std::pair<std::optional<T>, std::optional<T>>
-Cycle<T>::cycle_active(Direction direction)
+Cycle<T, Indexed>::cycle_active(Direction direction)
 {
     push_active_to_stack();
 
@@ -512,51 +579,59 @@ Cycle<T>::cycle_active(Direction direction)
     };
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 std::pair<std::optional<T>, std::optional<T>>
-Cycle<T>::drag_active(Direction direction)
+Cycle<T, Indexed>::drag_active(Direction direction)
 {
     Index index = next_index(direction);
 
-    if (m_index != index && m_index < m_elements.size() && index < m_elements.size())
-        std::iter_swap(m_elements.begin() + m_index, m_elements.begin() + index);
+    if (m_index != index)
+        swap_indices(m_index, index);
 
     return cycle_active(direction);
 }
 
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::insert_at_front(T element)
+Cycle<T, Indexed>::insert_at_front(T element)
 {
     push_active_to_stack();
     m_elements.push_front(element);
     m_index = 0;
+
+    shift_indices(0, 1);
+    index_element(element, 0);
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::insert_at_back(T element)
+Cycle<T, Indexed>::insert_at_back(T element)
 {
     push_active_to_stack();
     m_elements.push_back(element);
     m_index = Util::last_index(m_elements);
+
+    index_element(element, m_index);
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::insert_before_index(Index index, T element)
+Cycle<T, Indexed>::insert_before_index(Index index, T element)
 {
     if (index >= m_elements.size())
         index = Util::last_index(m_elements);
 
     push_active_to_stack();
     m_elements.insert(m_elements.begin() + index, element);
+
+    shift_indices(index, 1);
+    index_element(element, index);
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::insert_after_index(Index index, T element)
+Cycle<T, Indexed>::insert_after_index(Index index, T element)
 {
     if (m_elements.empty() || index >= m_elements.size() - 1) {
         insert_at_back(element);
@@ -565,11 +640,14 @@ Cycle<T>::insert_after_index(Index index, T element)
 
     push_active_to_stack();
     m_elements.insert(m_elements.begin() + index + 1, element);
+
+    shift_indices(index + 1, 1);
+    index_element(element, index + 1);
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::insert_before_element(T other, T element)
+Cycle<T, Indexed>::insert_before_element(T other, T element)
 {
     std::optional<Index> index = index_of_element(other);
 
@@ -579,9 +657,9 @@ Cycle<T>::insert_before_element(T other, T element)
         insert_at_back(element);
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::insert_after_element(T other, T element)
+Cycle<T, Indexed>::insert_after_element(T other, T element)
 {
     std::optional<Index> index = index_of_element(other);
 
@@ -592,18 +670,26 @@ Cycle<T>::insert_after_element(T other, T element)
 }
 
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::clear()
+Cycle<T, Indexed>::clear()
 {
     m_elements.clear();
     m_stack.clear();
+
+    if constexpr (Indexed) {
+        m_indices.clear();
+        m_index_epoch += m_index_shifts.size();
+        m_index_shifts.clear();
+        m_indices_stale = false;
+        m_indexing = false;
+    }
 }
 
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::sync_active()
+Cycle<T, Indexed>::sync_active()
 {
     std::optional<T> element = get_active_from_stack();
     for (; element && !contains(*element); element = get_active_from_stack());
@@ -612,9 +698,9 @@ Cycle<T>::sync_active()
 }
 
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::push_index_to_stack(std::optional<Index> index)
+Cycle<T, Indexed>::push_index_to_stack(std::optional<Index> index)
 {
     if (!m_unwindable || !index)
         return;
@@ -626,9 +712,9 @@ Cycle<T>::push_index_to_stack(std::optional<Index> index)
     }
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 void
-Cycle<T>::push_active_to_stack()
+Cycle<T, Indexed>::push_active_to_stack()
 {
     if (!m_unwindable)
         return;
@@ -636,24 +722,142 @@ Cycle<T>::push_active_to_stack()
     push_index_to_stack(index());
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 std::optional<T>
-Cycle<T>::get_active_from_stack()
+Cycle<T, Indexed>::get_active_from_stack()
 {
     return m_stack.pop_back();
 }
 
 
-template <typename T>
+template <typename T, bool Indexed>
+void
+Cycle<T, Indexed>::index_element(T element, Index index)
+{
+    if constexpr (Indexed) {
+        if (!m_indexing) {
+            if (m_elements.size() > MIN_INDEXED_SIZE) {
+                m_indexing = true;
+                m_indices_stale = true;
+            }
+
+            return;
+        }
+
+        m_indices.emplace(
+            element,
+            std::pair{index, m_index_epoch + m_index_shifts.size()}
+        );
+    }
+}
+
+template <typename T, bool Indexed>
+void
+Cycle<T, Indexed>::unindex_element(T element)
+{
+    if constexpr (Indexed) {
+        if (!m_indexing)
+            return;
+
+        if (m_elements.size() <= MIN_INDEXED_SIZE / 2) {
+            m_indices.clear();
+            m_index_epoch += m_index_shifts.size();
+            m_index_shifts.clear();
+            m_indices_stale = false;
+            m_indexing = false;
+            return;
+        }
+
+        m_indices.erase(element);
+    }
+}
+
+// Small cycles are scanned linearly; larger ones keep a position per element.
+// Insertions and removals in the middle of the cycle shift the positions of
+// all subsequent elements. Rather than renumbering them eagerly, each shift is
+// logged, and a cached position is brought up to date by replaying the shifts
+// logged after it was recorded. Once the log fills up, all positions are
+// recomputed on the next lookup.
+template <typename T, bool Indexed>
+void
+Cycle<T, Indexed>::shift_indices(Index index, int delta)
+{
+    if constexpr (Indexed) {
+        if (!m_indexing || m_indices_stale)
+            return;
+
+        if (m_index_shifts.size() == MAX_INDEX_SHIFTS) {
+            invalidate_indices();
+            return;
+        }
+
+        m_index_shifts.push_back(IndexShift{
+            .index = index,
+            .delta = delta
+        });
+    }
+}
+
+template <typename T, bool Indexed>
+void
+Cycle<T, Indexed>::invalidate_indices()
+{
+    if constexpr (Indexed)
+        if (m_indexing) {
+            m_index_epoch += m_index_shifts.size();
+            m_index_shifts.clear();
+            m_indices_stale = true;
+        }
+}
+
+template <typename T, bool Indexed>
+std::optional<Index>
+Cycle<T, Indexed>::lookup_index(T element) const
+{
+    if (m_indices_stale)
+        reindex();
+
+    auto entry = m_indices.find(element);
+    if (entry == m_indices.end())
+        return std::nullopt;
+
+    auto& [index, epoch] = entry->second;
+
+    for (std::size_t i = epoch - m_index_epoch; i < m_index_shifts.size(); ++i) {
+        IndexShift const& shift = m_index_shifts[i];
+
+        if (shift.delta < 0 ? index > shift.index : index >= shift.index)
+            index += shift.delta;
+    }
+
+    epoch = m_index_epoch + m_index_shifts.size();
+    return index;
+}
+
+template <typename T, bool Indexed>
+void
+Cycle<T, Indexed>::reindex() const
+{
+    m_index_epoch += m_index_shifts.size();
+    m_index_shifts.clear();
+
+    for (Index i = m_elements.size(); i > 0; --i)
+        m_indices[m_elements[i - 1]] = std::pair{i - 1, m_index_epoch};
+
+    m_indices_stale = false;
+}
+
+
+template <typename T, bool Indexed>
 std::deque<T> const&
-Cycle<T>::as_deque() const
+Cycle<T, Indexed>::as_deque() const
 {
     return m_elements;
 }
 
-template <typename T>
+template <typename T, bool Indexed>
 std::vector<T> const&
-Cycle<T>::stack() const
+Cycle<T, Indexed>::stack() const
 {
     return m_stack.as_vector();
 }
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+extern "C" {
+#include <wayland-server-core.h>
+}
+
+typedef class Server* Server_ptr;
+typedef class Output* Output_ptr;
+
+typedef class FrameScheduler final {
+public:
+    enum class Mode {
+        Immediate,
+        Fixed,
+        Adaptive,
+    };
+
+    static constexpr std::size_t SAMPLE_COUNT = 32;
+    static constexpr std::chrono::microseconds SLACK = std::chrono::microseconds(1500);
+    static constexpr std::chrono::milliseconds MIN_DELAY = std::chrono::milliseconds(1);
+
+    FrameScheduler(Server_ptr, Output_ptr);
+    ~FrameScheduler();
+
+    void set_mode(Mode, std::chrono::microseconds = std::chrono::microseconds(0));
+    Mode mode() const { return m_mode; }
+
+    void schedule();
+    void record_commit(std::uint64_t);
+    void record_present(std::uint64_t, int);
+
+    std::chrono::microseconds render_budget() const;
+    bool scheduled() const { return m_scheduled; }
+
+    static int handle_render(void*);
+
+private:
+    std::uint64_t refresh_period() const;
+
+    Server_ptr mp_server;
+    Output_ptr mp_output;
+
+    Mode m_mode;
+    std::chrono::microseconds m_max_render_time;
+
+    std::array<std::uint64_t, SAMPLE_COUNT> m_samples;
+    std::size_t m_sample_index;
+    std::size_t m_sample_count;
+
+    std::uint64_t m_last_present;
+    std::uint64_t m_refresh;
+
+    bool m_scheduled;
+    struct wl_event_source* mp_render_source;
+
+}* FrameScheduler_ptr;
@@ -168,6 +168,15 @@ struct Padding final {
 
 typedef Padding Extents;
 
+inline bool
+operator==(Padding const& lhs, Padding const& rhs)
+{
+    return lhs.left == rhs.left
+        && lhs.right == rhs.right
+        && lhs.top == rhs.top
+        && lhs.bottom == rhs.bottom;
+}
+
 inline std::ostream&
 operator<<(std::ostream& os, Padding const& padding)
 {
@@ -9,6 +9,7 @@ extern "C" {
 #include <xkbcommon/xkbcommon.h>
 }
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <unordered_set>
@@ -41,6 +42,7 @@ struct CursorInput {
 typedef class Server* Server_ptr;
 typedef class Model* Model_ptr;
 typedef class Seat* Seat_ptr;
+typedef class Output* Output_ptr;
 typedef struct View* View_ptr;
 typedef struct Node* Node_ptr;
 
@@ -55,6 +57,9 @@ typedef struct Cursor {
         Resize,
     };
 
+    static constexpr std::chrono::milliseconds FOCUS_DELAY = std::chrono::milliseconds(30);
+    static constexpr std::chrono::milliseconds IDLE_NOTIFY_INTERVAL = std::chrono::milliseconds(500);
+
     Cursor(
         Server_ptr,
         Model_ptr,
@@ -76,6 +81,10 @@ typedef struct Cursor {
     void abort_cursor_interactive();
 
     void process_cursor_motion(uint32_t time);
+    void flush_cursor_motion();
+    void flush_cursor_focus();
+    Output_ptr output_under_cursor() const;
+    void forget_view(View_ptr);
 
     static void handle_cursor_motion(struct wl_listener*, void*);
     static void handle_cursor_motion_absolute(struct wl_listener*, void*);
@@ -92,6 +101,7 @@ typedef struct Cursor {
     static void handle_start_drag(struct wl_listener*, void*);
     static void handle_destroy_drag(struct wl_listener*, void*);
     static void handle_request_set_cursor(struct wl_listener*, void*);
+    static int handle_focus_timeout(void*);
 
     Server_ptr mp_server;
     Model_ptr mp_model;
@@ -110,6 +120,15 @@ typedef struct Cursor {
         uint32_t edges;
     } m_grab_state;
 
+    bool m_motion_pending;
+    uint32_t m_motion_time;
+    uint32_t m_idle_notify_time;
+
+    View_ptr mp_hovered_view;
+    View_ptr mp_focused_by_cursor;
+    bool m_focus_pending;
+    struct wl_event_source* mp_focus_source;
+
     struct wl_listener ml_cursor_motion;
     struct wl_listener ml_cursor_motion_absolute;
     struct wl_listener ml_cursor_button;
@@ -28,6 +28,18 @@ static const KeyBindings key_bindings = {
     .repeatable = false
   }
 },
+{ { XKB_KEY_S, MODKEY | WLR_MODIFIER_CTRL | WLR_MODIFIER_SHIFT },
+  {
+    .action = CALL(report_output_stats()),
+    .repeatable = false
+  }
+},
+{ { XKB_KEY_E, MODKEY | WLR_MODIFIER_CTRL | WLR_MODIFIER_SHIFT },
+  {
+    .action = CALL(set_power_saver(Toggle::Reverse)),
+    .repeatable = false
+  }
+},
 
 // view state modifiers
 { { XKB_KEY_c, MODKEY },
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <kranewl/ipc.hh>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <wayland-server-core.h>
+}
+
+typedef class Model* Model_ptr;
+typedef class Server* Server_ptr;
+typedef class Workspace* Workspace_ptr;
+typedef struct View* View_ptr;
+
+typedef class IPCServer final {
+public:
+    // clients that stop reading their replies are dropped past this backlog
+    static constexpr std::size_t MAX_PENDING_OUTPUT = 1 << 16;
+
+    // subscribers hold at most this many undelivered events, the last slot
+    // being reserved for the overflow notice
+    static constexpr std::size_t EVENT_QUEUE_CAPACITY = 128;
+
+    // events stay queued (and coalescable) while this much output is unsent
+    static constexpr std::size_t EVENT_OUTPUT_LOW_WATER = 1 << 12;
+
+    IPCServer(Server_ptr, Model_ptr);
+    ~IPCServer();
+
+    bool listen(std::string const&);
+    bool listening() const { return mp_socket_source != nullptr; }
+
+    std::string const& socket_path() const { return m_socket_path; }
+
+    void emit_focus(View_ptr, Workspace_ptr);
+    void emit_workspace(Workspace_ptr);
+    void emit_layout(Workspace_ptr);
+    void emit_view_registered(View_ptr);
+    void emit_view_unregistered(View_ptr);
+    void emit_title(View_ptr);
+    void emit_app_id(View_ptr);
+
+    static int handle_socket(int, uint32_t, void*);
+    static int handle_client(int, uint32_t, void*);
+    static void handle_deliver_events(void*);
+
+private:
+    struct QueuedEvent final {
+        IPC::Event event;
+        std::int64_t key;
+        std::int64_t value;
+        std::string strings;
+    };
+
+    typedef struct Client final {
+        IPCServer* ipc_server;
+        int fd;
+        struct wl_event_source* source;
+        std::vector<char> input;
+        std::vector<char> output;
+        std::vector<std::pair<std::size_t, int>> output_fds;
+
+        IPC::EventMask subscriptions;
+        std::vector<QueuedEvent> events;
+        std::size_t events_head;
+        std::size_t events_size;
+    }* Client_ptr;
+
+    bool subscribed(IPC::Event event) const
+    {
+        return m_subscriptions & IPC::event_bit(event);
+    }
+
+    void accept_clients();
+    void disconnect(Client_ptr);
+
+    bool receive(Client_ptr);
+    void dispatch(Client_ptr, IPC::Header const&, char const*);
+    void dispatch_batch(Client_ptr, IPC::Header const&, char const*);
+    bool flush(Client_ptr);
+
+    void reply(Client_ptr, IPC::Command, IPC::Status, std::string const& = {});
+    IPC::Status execute(Client_ptr, IPC::CommandSpec const&, std::int64_t const*, std::string&&, std::string&);
+
+    void subscribe(Client_ptr, IPC::EventMask);
+    void broadcast(QueuedEvent&&);
+    void enqueue(Client_ptr, QueuedEvent const&);
+    void serialize_events(Client_ptr, std::size_t);
+
+    Server_ptr mp_server;
+    Model_ptr mp_model;
+
+    std::string m_socket_path;
+    int m_socket_fd;
+    struct wl_event_source* mp_socket_source;
+
+    std::vector<Client_ptr> m_clients;
+    IPC::EventMask m_subscriptions;
+    struct wl_event_source* mp_deliver_source;
+
+}* IPCServer_ptr;
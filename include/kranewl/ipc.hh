@@ -0,0 +1,245 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// the wire format shared by the compositor and kranec; every message is an
+// 8-byte header followed by `length` bytes of payload, in host byte order
+namespace IPC
+{
+    static constexpr std::uint32_t MAX_PAYLOAD = 4096;
+    static constexpr std::size_t MAX_ARGUMENTS = 2;
+
+    enum class MessageType : std::uint16_t {
+        Command,
+        Reply,
+        Event,
+    };
+
+    struct Header final {
+        std::uint32_t length;
+        std::uint16_t type;
+        std::uint16_t code;
+    };
+
+    static_assert(sizeof(Header) == 8);
+
+    // a command payload holds one int64 per non-string argument, followed by
+    // the raw bytes of its string argument (if any), which runs to the end;
+    // a batch payload instead holds complete command messages, each answered
+    // in turn, with layouts and focus settled once after the last of them
+    enum class Argument : std::uint8_t {
+        None,
+        Index,
+        View,
+        Integer,
+        Toggle,
+        Direction,
+        Layout,
+        Criterium,
+        SyncPolicy,
+        Events,
+        String,
+        Commands,
+    };
+
+    enum class Command : std::uint16_t {
+        Ping,
+        Exit,
+        FocusedView,
+        FocusView,
+        KillView,
+        JumpView,
+        CycleFocus,
+        ActivateWorkspace,
+        ActivateContext,
+        ActivateOutput,
+        ToggleWorkspace,
+        ToggleContext,
+        ToggleOutput,
+        MoveViewToWorkspace,
+        MoveViewToContext,
+        MoveViewToOutput,
+        SetLayout,
+        ToggleLayout,
+        SetFloatingView,
+        SetFullscreenView,
+        SetStickyView,
+        SetIconifyView,
+        CenterView,
+        PopDeiconify,
+        DeiconifyAll,
+        Spawn,
+        SetMaxRenderTime,
+        SetPowerSaver,
+        SetAdaptiveSyncPolicy,
+        ReportOutputStats,
+        ResetOutputStats,
+        Subscribe,
+        Batch,
+        Snapshot,
+    };
+
+    // a reply payload holds an int32 status, followed by an optional message;
+    // the reply to a snapshot command carries the snapshot's memfd as
+    // SCM_RIGHTS ancillary data on its first byte
+    enum class Status : std::int32_t {
+        Ok,
+        UnknownCommand,
+        Malformed,
+        InvalidArgument,
+        NoSuchView,
+        Unavailable,
+    };
+
+    // an event payload holds two int64 values, followed by the event's
+    // strings (if any), separated by NUL bytes:
+    //   Overflow          events dropped,    0
+    //   Focus             view uid (or 0),   workspace index,  app_id, title
+    //   Workspace         workspace index,   context index
+    //   Layout            workspace index,   layout
+    //   ViewRegistered    view uid,          workspace index,  app_id, title
+    //   ViewUnregistered  view uid,          0
+    //   Title             view uid,          0,                title
+    //   AppId             view uid,          0,                app_id
+    enum class Event : std::uint16_t {
+        Overflow,
+        Focus,
+        Workspace,
+        Layout,
+        ViewRegistered,
+        ViewUnregistered,
+        Title,
+        AppId,
+    };
+
+    typedef std::uint32_t EventMask;
+
+    static constexpr EventMask
+    event_bit(Event event)
+    {
+        return EventMask{1} << static_cast<unsigned>(event);
+    }
+
+    struct CommandSpec final {
+        Command command;
+        std::string_view name;
+        std::array<Argument, MAX_ARGUMENTS> arguments;
+    };
+
+    // view arguments take a uid as reported by focused-view, zero denoting
+    // the focused view; ordered by Command
+    static constexpr std::array COMMANDS = {
+        CommandSpec{ Command::Ping,                  "ping",                     {} },
+        CommandSpec{ Command::Exit,                  "exit",                     {} },
+        CommandSpec{ Command::FocusedView,           "focused-view",             {} },
+        CommandSpec{ Command::FocusView,             "focus-view",               { Argument::View } },
+        CommandSpec{ Command::KillView,              "kill-view",                { Argument::View } },
+        CommandSpec{ Command::JumpView,              "jump-view",                { Argument::Criterium, Argument::String } },
+        CommandSpec{ Command::CycleFocus,            "cycle-focus",              { Argument::Direction } },
+        CommandSpec{ Command::ActivateWorkspace,     "activate-workspace",       { Argument::Index } },
+        CommandSpec{ Command::ActivateContext,       "activate-context",         { Argument::Index } },
+        CommandSpec{ Command::ActivateOutput,        "activate-output",          { Argument::Index } },
+        CommandSpec{ Command::ToggleWorkspace,       "toggle-workspace",         {} },
+        CommandSpec{ Command::ToggleContext,         "toggle-context",           {} },
+        CommandSpec{ Command::ToggleOutput,          "toggle-output",            {} },
+        CommandSpec{ Command::MoveViewToWorkspace,   "move-view-to-workspace",   { Argument::View, Argument::Index } },
+        CommandSpec{ Command::MoveViewToContext,     "move-view-to-context",     { Argument::View, Argument::Index } },
+        CommandSpec{ Command::MoveViewToOutput,      "move-view-to-output",      { Argument::View, Argument::Index } },
+        CommandSpec{ Command::SetLayout,             "set-layout",               { Argument::Layout } },
+        CommandSpec{ Command::ToggleLayout,          "toggle-layout",            {} },
+        CommandSpec{ Command::SetFloatingView,       "set-floating-view",        { Argument::View, Argument::Toggle } },
+        CommandSpec{ Command::SetFullscreenView,     "set-fullscreen-view",      { Argument::View, Argument::Toggle } },
+        CommandSpec{ Command::SetStickyView,         "set-sticky-view",          { Argument::View, Argument::Toggle } },
+        CommandSpec{ Command::SetIconifyView,        "set-iconify-view",         { Argument::View, Argument::Toggle } },
+        CommandSpec{ Command::CenterView,            "center-view",              { Argument::View } },
+        CommandSpec{ Command::PopDeiconify,          "pop-deiconify",            {} },
+        CommandSpec{ Command::DeiconifyAll,          "deiconify-all",            {} },
+        CommandSpec{ Command::Spawn,                 "spawn",                    { Argument::String } },
+        CommandSpec{ Command::SetMaxRenderTime,      "set-max-render-time",      { Argument::Integer } },
+        CommandSpec{ Command::SetPowerSaver,         "set-power-saver",          { Argument::Toggle } },
+        CommandSpec{ Command::SetAdaptiveSyncPolicy, "set-adaptive-sync-policy", { Argument::SyncPolicy } },
+        CommandSpec{ Command::ReportOutputStats,     "report-output-stats",      {} },
+        CommandSpec{ Command::ResetOutputStats,      "reset-output-stats",       {} },
+        CommandSpec{ Command::Subscribe,             "subscribe",                { Argument::Events } },
+        CommandSpec{ Command::Batch,                 "batch",                    { Argument::Commands } },
+        CommandSpec{ Command::Snapshot,              "snapshot",                 {} },
+    };
+
+    static_assert([]() {
+        for (std::size_t i = 0; i < COMMANDS.size(); ++i)
+            if (static_cast<std::size_t>(COMMANDS[i].command) != i)
+                return false;
+
+        return true;
+    }());
+
+    // symbolic arguments travel as their index into these tables
+    static constexpr std::array<std::string_view, 3> TOGGLE_NAMES = {
+        "on", "off", "toggle",
+    };
+
+    static constexpr std::array<std::string_view, 2> DIRECTION_NAMES = {
+        "forward", "backward",
+    };
+
+    // ordered by LayoutHandler::LayoutKind
+    static constexpr std::array<std::string_view, 18> LAYOUT_NAMES = {
+        "float", "frameless-float", "single-float", "frameless-single-float",
+        "center", "monocle", "main-deck", "stack-deck", "double-deck",
+        "paper", "compact-paper", "overlapping-paper",
+        "double-stack", "compact-double-stack",
+        "horizontal-stack", "compact-horizontal-stack",
+        "vertical-stack", "compact-vertical-stack",
+    };
+
+    static constexpr std::array<std::string_view, 6> CRITERIUM_NAMES = {
+        "title-equals", "app-id-equals", "handle-equals",
+        "title-contains", "app-id-contains", "handle-contains",
+    };
+
+    // ordered by Output::AdaptiveSyncPolicy
+    static constexpr std::array<std::string_view, 4> SYNC_POLICY_NAMES = {
+        "never", "always", "fullscreen", "opt-in",
+    };
+
+    // ordered by Event; overflow is always reported, whatever the mask
+    static constexpr std::array<std::string_view, 8> EVENT_NAMES = {
+        "overflow", "focus", "workspace", "layout",
+        "view-registered", "view-unregistered", "title", "app-id",
+    };
+
+    inline CommandSpec const*
+    command_spec(std::uint16_t code)
+    {
+        return code < COMMANDS.size() ? &COMMANDS[code] : nullptr;
+    }
+
+    inline std::optional<std::string>
+    socket_path(char const* display)
+    {
+        char const* runtime_dir = std::getenv("XDG_RUNTIME_DIR");
+
+        if (!runtime_dir || !display)
+            return std::nullopt;
+
+        return std::string{runtime_dir}
+            + "/kranewl."
+            + display
+            + ".sock";
+    }
+
+    // clients prefer the path the compositor exported to its children
+    inline std::optional<std::string>
+    client_socket_path()
+    {
+        if (char const* path = std::getenv("KRANEWL_SOCKET"))
+            return std::string{path};
+
+        return socket_path(std::getenv("WAYLAND_DISPLAY"));
+    }
+}
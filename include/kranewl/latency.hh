@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+
+typedef class LatencyHistogram final {
+public:
+    static constexpr std::uint64_t BUCKET_WIDTH_NS = 250'000;
+    static constexpr std::size_t BUCKET_COUNT = 256;
+
+    LatencyHistogram();
+    ~LatencyHistogram();
+
+    void record(std::uint64_t);
+    void reset();
+
+    std::uint64_t count() const { return m_count; }
+    std::uint64_t min() const { return m_count ? m_min : 0; }
+    std::uint64_t max() const { return m_max; }
+    std::uint64_t mean() const { return m_count ? m_sum / m_count : 0; }
+    std::uint64_t overflow() const { return m_overflow; }
+
+    std::uint64_t percentile(double) const;
+    std::string summary() const;
+
+private:
+    std::array<std::uint64_t, BUCKET_COUNT> m_buckets;
+    std::uint64_t m_overflow;
+    std::uint64_t m_count;
+    std::uint64_t m_sum;
+    std::uint64_t m_min;
+    std::uint64_t m_max;
+
+}* LatencyHistogram_ptr;
+
+typedef class LatencyTracker final {
+public:
+    static constexpr std::size_t MAX_IN_FLIGHT = 4;
+    static constexpr std::uint64_t MAX_INPUT_AGE_NS = 1'000'000'000;
+
+    LatencyTracker();
+    ~LatencyTracker();
+
+    static std::optional<std::uint64_t> input_time(std::uint32_t);
+    static std::uint64_t now();
+
+    void mark_input(std::uint64_t);
+    void commit(std::uint32_t);
+    void present(std::uint32_t, bool, std::uint64_t);
+
+    LatencyHistogram const& histogram() const { return m_histogram; }
+    void reset();
+
+private:
+    struct InFlight final {
+        std::uint32_t commit_seq;
+        std::uint64_t input_time;
+    };
+
+    std::optional<std::uint64_t> m_input_time;
+    std::deque<InFlight> m_in_flight;
+    LatencyHistogram m_histogram;
+
+}* LatencyTracker_ptr;
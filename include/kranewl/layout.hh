@@ -6,11 +6,10 @@
 #include <kranewl/util.hh>
 
 #include <vector>
-#include <deque>
 #include <unordered_map>
 
 class LayoutHandler final {
-    typedef std::deque<View_ptr>::const_iterator view_iter;
+    typedef std::vector<View_ptr>::const_iterator view_iter;
     typedef std::vector<Placement>& placement_vector;
 
 public:
@@ -6,8 +6,13 @@
 #include <kranewl/input/bindings.hh>
 #include <kranewl/layout.hh>
 #include <kranewl/placement.hh>
+#include <kranewl/rule-matcher.hh>
 #include <kranewl/rules.hh>
+#include <kranewl/search-index.hh>
 #include <kranewl/search.hh>
+#include <kranewl/snapshot-writer.hh>
+#include <kranewl/spatial-index.hh>
+#include <kranewl/transaction.hh>
 #include <kranewl/tree/layer.hh>
 #include <kranewl/tree/view.hh>
 
@@ -24,6 +29,7 @@ typedef class Output* Output_ptr;
 typedef class Context* Context_ptr;
 typedef class Workspace* Workspace_ptr;
 typedef class Server* Server_ptr;
+typedef class RulesWatcher* RulesWatcher_ptr;
 typedef struct View* View_ptr;
 typedef struct XWayland* XWayland_ptr;
 typedef struct XDGView* XDGView_ptr;
@@ -36,17 +42,36 @@ class Config;
 class Model final
 {
 public:
+    struct LayoutCounters final {
+        std::size_t arranges;
+        std::size_t arranges_coalesced;
+        std::size_t placements;
+        std::size_t configures_skipped;
+        std::size_t relayers_skipped;
+        std::size_t maps_skipped;
+    };
+
+    struct FrameRateCaps final {
+        unsigned unfocused;
+        unsigned background;
+    };
+
+    static constexpr FrameRateCaps DEFAULT_FRAME_RATE_CAPS = { 0, 0 };
+    static constexpr FrameRateCaps POWER_SAVER_FRAME_RATE_CAPS = { 30, 10 };
+
     Model(Config const&);
     ~Model();
 
     void evaluate_user_env_vars(std::optional<std::string> const&);
     void retrieve_user_default_rules(std::optional<std::string> const&);
+    void reload_user_default_rules();
     void run_user_autostart(std::optional<std::string> const&);
 
     void register_server(Server_ptr);
     void exit();
 
     View_ptr focused_view() const;
+    View_ptr view(Uid) const;
     Workspace_ptr workspace(Index) const;
     Context_ptr context(Index) const;
     Output_ptr output(Index) const;
@@ -64,6 +89,16 @@ public:
     void output_reserve_context(Output_ptr);
     void update_outputs();
 
+    void register_input(uint32_t);
+    void register_input(uint32_t, Output_ptr);
+    void report_output_stats();
+    void reset_output_stats();
+    void set_max_render_time(std::optional<int>);
+    void set_adaptive_sync_policy(Output::AdaptiveSyncPolicy);
+
+    void set_power_saver(Toggle);
+    unsigned frame_rate_cap(View_ptr) const;
+
     XDGView_ptr create_xdg_shell_view(struct wlr_xdg_surface*, Seat_ptr);
 #ifdef XWAYLAND
     XWaylandView_ptr create_xwayland_view(
@@ -96,6 +131,9 @@ public:
     bool view_matches_search(View_ptr, SearchSelector const&) const;
     View_ptr search_view(SearchSelector const&);
     void jump_view(SearchSelector const&);
+    void reindex_view(View_ptr);
+
+    SpatialIndex& spatial_index() { return m_spatial_index; }
 
     void focus_output(Output_ptr);
 
@@ -113,6 +151,9 @@ public:
     void sync_focus();
     void sync_indicators();
 
+    void publish_snapshot();
+    int snapshot_fd() const;
+
     void relayer_views(Workspace_ptr);
     void relayer_views(Context_ptr);
     void relayer_views(Output_ptr);
@@ -177,6 +218,15 @@ public:
 
     void apply_layout(Index);
     void apply_layout(Workspace_ptr);
+    void arrange_dirty_workspaces();
+    static void handle_arrange(void*);
+    LayoutCounters const& layout_counters() const;
+    void begin_batch();
+    void commit_batch();
+    void update_occlusion(Workspace_ptr);
+
+    void acknowledge_configure(View_ptr);
+    bool transaction_pending(Output_ptr) const;
 
     void kill_focus();
     void kill_view(View_ptr);
@@ -220,6 +270,8 @@ public:
     Workspace_ptr mp_workspace;
 
 private:
+    void arrange_workspace(Workspace_ptr);
+
     Server_ptr mp_server;
     Config const& m_config;
 
@@ -237,15 +289,31 @@ private:
     std::unordered_map<Uid, Node_ptr> m_unmanaged_map;
     std::unordered_map<pid_t, View_ptr> m_pid_map;
     std::unordered_map<View_ptr, Region> m_fullscreen_map;
-
-    std::vector<View_ptr> m_sticky_views;
+    SearchIndex m_search_index;
+    SpatialIndex m_spatial_index;
 
     View_ptr mp_focus;
     View_ptr mp_jumped_from;
     View_ptr mp_next_view;
     View_ptr mp_prev_view;
 
-    std::vector<std::tuple<SearchSelector_ptr, Rules>> m_default_rules;
+    RuleMatcher m_default_rules;
+    std::optional<std::string> m_rules_path;
+    RulesWatcher_ptr mp_rules_watcher;
+
+    LayoutCounters m_layout_counters;
+    std::vector<Region> m_occluders;
+    std::vector<View_ptr> m_occluded_views;
+
+    bool m_power_saver;
+    Transaction_ptr mp_transaction;
+
+    unsigned m_batch_depth;
+    bool m_focus_sync_deferred;
+    std::vector<Workspace_ptr> m_dirty_workspaces;
+    struct wl_event_source* mp_arrange_source;
+
+    SnapshotWriter m_snapshot_writer;
 
     const KeyBindings m_key_bindings;
     const CursorBindings m_cursor_bindings;
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <kranewl/common.hh>
+#include <kranewl/rules.hh>
+#include <kranewl/search.hh>
+
+#include <array>
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+typedef struct View* View_ptr;
+
+typedef class RuleMatcher final {
+public:
+    static constexpr std::size_t MEMO_CAPACITY = 256;
+
+    RuleMatcher();
+    RuleMatcher(RuleMatcher const&) = delete;
+    RuleMatcher(RuleMatcher&&) = default;
+    ~RuleMatcher();
+
+    RuleMatcher& operator=(RuleMatcher const&) = delete;
+    RuleMatcher& operator=(RuleMatcher&&) = default;
+
+    bool add_rule(SearchSelector::SelectionCriterium, std::string const&, Rules const&);
+    void compile();
+
+    std::optional<Rules> match(View_ptr);
+    std::optional<Rules> match(std::string const&, std::string const&, std::string const&);
+
+    void clear_memo();
+
+    std::size_t size() const { return m_rules.size(); }
+    bool empty() const { return m_rules.empty(); }
+
+private:
+    static constexpr std::size_t KEY_COUNT = 3;
+    static constexpr Index NO_RULE = static_cast<Index>(-1);
+
+    struct Automaton final {
+        struct Node final {
+            std::vector<std::pair<unsigned char, Index>> edges;
+            Index fail;
+            Index best;
+        };
+
+        Automaton();
+
+        void insert(std::string const&, Index);
+        void compile();
+        Index search(std::string const&) const;
+
+        Index child(Index, unsigned char) const;
+
+        std::vector<Node> nodes;
+    };
+
+    typedef std::list<std::pair<std::string, Index>> MemoList;
+
+    Index match_index(std::string const&, std::string const&, std::string const&) const;
+
+    std::vector<Rules> m_rules;
+    std::array<std::unordered_map<std::string, Index>, KEY_COUNT> m_exact;
+    std::array<Automaton, KEY_COUNT> m_contains;
+
+    MemoList m_memo;
+    std::unordered_map<std::string, MemoList::iterator> m_memo_map;
+
+}* RuleMatcher_ptr;
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+extern "C" {
+#include <wayland-server-core.h>
+}
+
+typedef class Model* Model_ptr;
+typedef class Server* Server_ptr;
+
+typedef class RulesWatcher final {
+public:
+    static constexpr std::chrono::milliseconds DEBOUNCE = std::chrono::milliseconds(50);
+
+    RulesWatcher(Server_ptr, Model_ptr, std::string const&);
+    ~RulesWatcher();
+
+    bool watching() const { return mp_inotify_source != nullptr; }
+
+    static int handle_inotify(int, uint32_t, void*);
+    static int handle_debounce(void*);
+
+private:
+    Server_ptr mp_server;
+    Model_ptr mp_model;
+
+    std::string m_rules_path;
+    std::string m_rules_name;
+
+    int m_inotify_fd;
+    int m_watch_descriptor;
+
+    struct wl_event_source* mp_inotify_source;
+    struct wl_event_source* mp_debounce_source;
+
+}* RulesWatcher_ptr;
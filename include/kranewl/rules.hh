@@ -4,13 +4,17 @@
 #include <kranewl/search.hh>
 
 #include <optional>
-#include <vector>
+#include <string>
 
 extern "C" {
 #include <wlr/util/edges.h>
 }
 
+typedef class RuleMatcher* RuleMatcher_ptr;
+
 struct Rules {
+    static constexpr unsigned MAX_FRAME_RATE = 1000;
+
     Rules()
         : do_focus(std::nullopt),
           do_float(std::nullopt),
@@ -19,7 +23,9 @@ struct Rules {
           to_output(std::nullopt),
           to_context(std::nullopt),
           to_workspace(std::nullopt),
-          snap_edges(std::nullopt)
+          snap_edges(std::nullopt),
+          do_adaptive_sync(std::nullopt),
+          frame_rate(std::nullopt)
     {}
 
     ~Rules() = default;
@@ -32,9 +38,10 @@ struct Rules {
     std::optional<Index> to_context;
     std::optional<Index> to_workspace;
     std::optional<uint32_t> snap_edges;
+    std::optional<bool> do_adaptive_sync;
+    std::optional<unsigned> frame_rate;
 
-    static std::vector<std::tuple<SearchSelector_ptr, Rules>>
-        compile_default_rules(std::string const&);
+    static bool compile_default_rules(std::string const&, RuleMatcher&);
 
     static Rules parse_rules(std::string_view, bool = false);
     static Rules merge_rules(Rules const&, Rules const&);
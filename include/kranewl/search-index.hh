@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+typedef struct View* View_ptr;
+
+typedef class SearchIndex final {
+public:
+    enum class Key {
+        Title,
+        AppId,
+        Handle,
+    };
+
+    SearchIndex();
+    ~SearchIndex();
+
+    void insert(View_ptr);
+    void update(View_ptr);
+    void erase(View_ptr);
+    void touch(View_ptr);
+
+    View_ptr find_equal(Key, std::string const&) const;
+    View_ptr find_containing(Key, std::string const&) const;
+    View_ptr find_most_recent(std::function<bool(const View_ptr)> const&) const;
+
+private:
+    typedef std::uint32_t Trigram;
+
+    static constexpr std::size_t KEY_COUNT = 3;
+
+    struct Entry final {
+        std::array<std::string, KEY_COUNT> values;
+        std::list<View_ptr>::iterator mru_position;
+        std::uint64_t last_touched;
+    };
+
+    static std::string const& value_of(View_ptr, Key);
+    static void extract_trigrams(Key, std::string const&, std::vector<Trigram>&);
+
+    void index_value(View_ptr, Key, std::string const&);
+    void unindex_value(View_ptr, Key, std::string const&);
+
+    View_ptr most_recent(std::vector<View_ptr> const&, Key, std::string const*) const;
+
+    std::unordered_map<View_ptr, Entry> m_entries;
+    std::array<std::unordered_map<std::string, std::vector<View_ptr>>, KEY_COUNT> m_values;
+    std::unordered_map<Trigram, std::vector<View_ptr>> m_trigrams;
+    std::list<View_ptr> m_mru;
+    std::uint64_t m_touches;
+
+    mutable std::vector<Trigram> m_trigram_buffer;
+
+}* SearchIndex_ptr;
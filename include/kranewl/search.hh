@@ -87,7 +87,7 @@ public:
         case SearchSelectorTag::OnWorkspaceBySelector: return SelectionCriterium::OnWorkspaceBySelector;
         case SearchSelectorTag::ByTitleEquals:         return SelectionCriterium::ByTitleEquals;
         case SearchSelectorTag::ByAppIdEquals:         return SelectionCriterium::ByAppIdEquals;
-        case SearchSelectorTag::ByHandleEquals:        return SelectionCriterium::ByAppIdEquals;
+        case SearchSelectorTag::ByHandleEquals:        return SelectionCriterium::ByHandleEquals;
         case SearchSelectorTag::ByTitleContains:       return SelectionCriterium::ByTitleContains;
         case SearchSelectorTag::ByAppIdContains:       return SelectionCriterium::ByAppIdContains;
         case SearchSelectorTag::ByHandleContains:      return SelectionCriterium::ByHandleContains;
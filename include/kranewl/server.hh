@@ -16,6 +16,7 @@ extern "C" {
 #include <string>
 #include <unordered_map>
 
+typedef class IPCServer* IPCServer_ptr;
 typedef class Model* Model_ptr;
 typedef class Server* Server_ptr;
 typedef struct View* View_ptr;
@@ -73,6 +74,7 @@ public:
     struct wlr_output* mp_fallback_output;
     struct wlr_output_manager_v1* mp_output_manager;
     struct wlr_drm_lease_v1_manager* mp_drm_lease_manager;
+    IPCServer_ptr mp_ipc_server = nullptr;
 
     std::unordered_map<Uid, XDGDecoration_ptr> m_decorations;
 
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <kranewl/snapshot.hh>
+
+typedef class SnapshotWriter final {
+public:
+    SnapshotWriter();
+    SnapshotWriter(SnapshotWriter const&) = delete;
+    ~SnapshotWriter();
+
+    SnapshotWriter& operator=(SnapshotWriter const&) = delete;
+
+    bool available() const { return mp_snapshot != nullptr; }
+    int fd() const { return m_fd; }
+
+    IPC::Snapshot::State& begin();
+    void end();
+
+private:
+    int m_fd;
+    IPC::Snapshot* mp_snapshot;
+
+}* SnapshotWriter_ptr;
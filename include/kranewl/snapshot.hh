@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+// the layout of the shared-memory state snapshot; the compositor hands out
+// a sealed memfd holding one of these through the IPC snapshot command, and
+// readers map it read-only and poll it without ever contacting the server
+namespace IPC
+{
+    static constexpr std::uint32_t SNAPSHOT_MAGIC = 0x6b72736e; // "nsrk"
+    static constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+    static constexpr std::uint32_t SNAPSHOT_NONE = static_cast<std::uint32_t>(-1);
+
+    static constexpr std::size_t SNAPSHOT_MAX_WORKSPACES = 128;
+    static constexpr std::size_t SNAPSHOT_MAX_APP_ID = 256;
+    static constexpr std::size_t SNAPSHOT_MAX_TITLE = 512;
+
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+
+    struct Snapshot final {
+        struct Workspace final {
+            std::uint32_t view_count;
+            std::uint32_t layout;
+        };
+
+        struct State final {
+            std::uint32_t output;
+            std::uint32_t context;
+            std::uint32_t workspace;
+            std::uint32_t workspace_count;
+            std::uint64_t focus;
+            std::array<Workspace, SNAPSHOT_MAX_WORKSPACES> workspaces;
+            char focus_app_id[SNAPSHOT_MAX_APP_ID];
+            char focus_title[SNAPSHOT_MAX_TITLE];
+        };
+
+        std::uint32_t magic;
+        std::uint32_t version;
+
+        // odd while the writer is updating the state (seqlock)
+        std::atomic<std::uint32_t> sequence;
+        std::uint32_t padding;
+
+        State state;
+    };
+
+    // copies out a consistent state, returning false if the writer kept
+    // interfering for the given number of attempts
+    inline bool
+    read_snapshot(
+        Snapshot const* snapshot,
+        Snapshot::State& state,
+        unsigned attempts = 1024
+    )
+    {
+        while (attempts--) {
+            std::uint32_t sequence = snapshot->sequence.load(std::memory_order_acquire);
+
+            if (sequence & 1)
+                continue;
+
+            std::memcpy(&state, &snapshot->state, sizeof(state));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (snapshot->sequence.load(std::memory_order_relaxed) == sequence)
+                return true;
+        }
+
+        return false;
+    }
+}
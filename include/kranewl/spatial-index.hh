@@ -0,0 +1,53 @@
+#pragma once
+
+#include <kranewl/geometry.hh>
+#include <kranewl/scene-layer.hh>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+typedef struct Node* Node_ptr;
+struct wlr_scene_node;
+
+typedef class SpatialIndex final {
+public:
+    static constexpr int CELL_SIZE = 256;
+    static constexpr int MAX_CELL_SPAN = 64;
+
+    struct Entry final {
+        Node_ptr node;
+        struct wlr_scene_node* scene;
+        SceneLayer layer;
+        Region region;
+        bool unbounded;
+        bool celled;
+        int cell_x0, cell_y0;
+        int cell_x1, cell_y1;
+    };
+
+    SpatialIndex();
+    ~SpatialIndex();
+
+    void insert(Node_ptr, struct wlr_scene_node*, SceneLayer, Region const&);
+    void relayer(Node_ptr, SceneLayer);
+    void set_unbounded(Node_ptr, bool);
+    void erase(Node_ptr);
+
+    void query(Pos, std::vector<Entry const*>&) const;
+
+    bool contains(Node_ptr node) const { return m_entries.contains(node); }
+    std::size_t size() const { return m_entries.size(); }
+
+private:
+    static std::uint64_t cell_key(int, int);
+    static int cell_of(int);
+
+    void link(Entry&);
+    void unlink(Entry&);
+
+    std::unordered_map<Node_ptr, Entry> m_entries;
+    std::unordered_map<std::uint64_t, std::vector<Entry*>> m_cells;
+    std::vector<Entry*> m_uncelled;
+
+}* SpatialIndex_ptr;
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <kranewl/geometry.hh>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+extern "C" {
+#include <wayland-server-core.h>
+}
+
+typedef class Server* Server_ptr;
+typedef class Model* Model_ptr;
+typedef class Output* Output_ptr;
+typedef struct View* View_ptr;
+
+typedef class Transaction final {
+public:
+    static constexpr std::chrono::milliseconds TIMEOUT = std::chrono::milliseconds(200);
+
+    Transaction(Server_ptr, Model_ptr);
+    ~Transaction();
+
+    void add(View_ptr, Region const&, Extents const&);
+    void remove(View_ptr);
+    void acknowledge(View_ptr);
+    void commit();
+
+    bool pending() const;
+    bool pending(Output_ptr) const;
+
+    static int handle_timeout(void*);
+
+private:
+    struct Instruction final {
+        View_ptr view;
+        Region region;
+        Extents extents;
+        bool awaiting_ack;
+    };
+
+    void apply();
+
+    Server_ptr mp_server;
+    Model_ptr mp_model;
+
+    std::vector<Instruction> m_instructions;
+    std::size_t m_awaiting_acks;
+    bool m_timeout_armed;
+
+    struct wl_event_source* mp_timeout_source;
+
+}* Transaction_ptr;
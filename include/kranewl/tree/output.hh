@@ -2,7 +2,9 @@
 
 #include <kranewl/common.hh>
 #include <kranewl/context.hh>
+#include <kranewl/frame-scheduler.hh>
 #include <kranewl/geometry.hh>
+#include <kranewl/latency.hh>
 #include <kranewl/scene-layer.hh>
 #include <kranewl/tree/node.hh>
 
@@ -11,6 +13,9 @@ extern "C" {
 #include <wlr/types/wlr_output.h>
 }
 
+#include <chrono>
+#include <ctime>
+#include <optional>
 #include <unordered_map>
 #include <vector>
 
@@ -19,9 +24,35 @@ typedef class Model* Model_ptr;
 typedef class Context* Context_ptr;
 typedef class Workspace* Workspace_ptr;
 typedef class Layer* Layer_ptr;
+typedef struct View* View_ptr;
+
+struct wlr_scene_output;
+struct wlr_surface;
 
 typedef class Output final {
 public:
+    static constexpr std::chrono::milliseconds FRAME_TOLERANCE = std::chrono::milliseconds(2);
+    static constexpr unsigned ADAPTIVE_SYNC_ATTEMPTS = 3;
+
+    struct FrameStats final {
+        uint64_t committed;
+        uint64_t skipped;
+        uint64_t deferred;
+        uint64_t failed;
+    };
+
+    enum class AdaptiveSyncPolicy {
+        Never,
+        Always,
+        Fullscreen,
+        OptIn,
+    };
+
+    struct ScanoutStats final {
+        uint64_t scanned_out;
+        uint64_t composited;
+    };
+
     Output(
         Server_ptr,
         Model_ptr,
@@ -35,6 +66,10 @@ public:
     static void handle_frame(struct wl_listener*, void*);
     static void handle_present(struct wl_listener*, void*);
     static void handle_destroy(struct wl_listener*, void*);
+    static int handle_frame_throttle(void*);
+
+    void render();
+    void send_frame_done(struct wlr_scene_output*, struct timespec const&);
 
     void set_context(Context_ptr);
     Context_ptr context() const;
@@ -64,6 +99,16 @@ public:
 
     void arrange_layers();
 
+    View_ptr scanout_view() const { return mp_scanout_view; }
+    void set_scanout_view(View_ptr);
+    char const* scanout_blocker() const;
+    char const* last_scanout_blocker() const { return mp_scanout_blocker; }
+    bool hides_layer(SceneLayer) const;
+
+    AdaptiveSyncPolicy adaptive_sync_policy() const { return m_adaptive_sync_policy; }
+    void set_adaptive_sync_policy(AdaptiveSyncPolicy);
+    void update_adaptive_sync();
+
 private:
     Context_ptr mp_context;
     Region m_full_region;
@@ -73,6 +118,28 @@ private:
 
     std::unordered_map<SceneLayer, std::vector<Layer_ptr>> m_layer_map;
 
+    View_ptr mp_scanout_view;
+    char const* mp_scanout_blocker;
+
+    AdaptiveSyncPolicy m_adaptive_sync_policy;
+    std::optional<bool> m_adaptive_sync_request;
+    unsigned m_adaptive_sync_attempts;
+
+    void request_adaptive_sync_frame();
+    void settle_adaptive_sync();
+
+    bool throttle_view(View_ptr, uint64_t, uint64_t&) const;
+    void arm_frame_throttle(uint64_t);
+
+    static void withhold_surface(struct wlr_surface*, int, int, void*);
+    static void send_surface_frame_done(struct wlr_surface*, int, int, void*);
+    static void release_surface_frame_done(struct wlr_surface*, int, int, void*);
+
+    std::vector<View_ptr> m_throttled_views;
+    std::vector<struct wlr_surface*> m_withheld_surfaces;
+    struct timespec m_frame_time;
+    struct wl_event_source* mp_frame_throttle_source;
+
 public:
     Server_ptr mp_server;
     Model_ptr mp_model;
@@ -83,6 +150,11 @@ public:
 
     bool m_dirty;
 
+    LatencyTracker m_latency;
+    FrameScheduler m_frame_scheduler;
+    FrameStats m_frame_stats;
+    ScanoutStats m_scanout_stats;
+
     struct wlr_output* mp_wlr_output = nullptr;
 
     struct wl_listener ml_frame;
@@ -6,8 +6,10 @@
 #include <kranewl/scene-layer.hh>
 #include <kranewl/tree/node.hh>
 
-#include <vector>
 #include <chrono>
+#include <optional>
+#include <utility>
+#include <vector>
 
 extern "C" {
 #include <sys/types.h>
@@ -29,6 +31,7 @@ typedef struct View* View_ptr;
 typedef struct View : public Node {
     static constexpr Dim MIN_VIEW_DIM = Dim{25, 10};
     static constexpr Dim PREFERRED_INIT_VIEW_DIM = Dim{480, 260};
+    static constexpr std::chrono::milliseconds PACING_TIMEOUT = std::chrono::milliseconds(200);
 
     enum class OutsideState {
         Focused,
@@ -71,15 +74,27 @@ typedef struct View : public Node {
     virtual void activate(Toggle) = 0;
     virtual void effectuate_fullscreen(bool) = 0;
 
-    virtual void configure(Region const&, Extents const&, bool) = 0;
+    virtual bool send_configure(Region const&, Extents const&) = 0;
     virtual void close() = 0;
     virtual void close_popups() = 0;
+    virtual bool has_popups() const { return false; }
+
+    void configure(Region const&, Extents const&, bool);
+    void apply_configure(Region const&, Extents const&);
+    void flush_paced_configure();
+    void schedule_frame();
+
+    void set_occluded(bool);
+    void set_decoration_hidden(bool);
+    bool surface_opaque() const;
+    void update_opaque();
 
     void map();
     void unmap();
     void center();
     void tile(Toggle);
     void relayer(SceneLayer);
+    void reparent();
     void raise() const;
     void lower() const;
 
@@ -114,6 +129,12 @@ typedef struct View : public Node {
     bool iconifyable() const { return m_iconifyable; }
     bool iconified() const { return m_iconified; }
     bool disowned() const { return m_disowned; }
+    bool occluded() const { return m_occluded; }
+    bool opaque() const { return m_opaque; }
+    std::optional<bool> adaptive_sync() const { return m_adaptive_sync; }
+    void set_adaptive_sync(bool adaptive_sync) { m_adaptive_sync = adaptive_sync; }
+    std::optional<unsigned> frame_rate() const { return m_frame_rate; }
+    void set_frame_rate(unsigned frame_rate) { m_frame_rate = frame_rate; }
     void set_activated(bool);
     void set_focused(bool);
     void set_mapped(bool);
@@ -131,6 +152,7 @@ typedef struct View : public Node {
     void set_disowned(bool);
 
     bool belongs_to_active_track() const;
+    bool configured_as(Region const&, Extents const&) const;
 
     std::chrono::time_point<std::chrono::steady_clock> last_focused() const;
     std::chrono::time_point<std::chrono::steady_clock> last_touched() const;
@@ -194,6 +216,7 @@ typedef struct View : public Node {
 
     float m_alpha;
     uint32_t m_resize;
+    uint64_t m_last_frame_done;
 
 protected:
 
@@ -201,6 +224,14 @@ protected:
         struct wl_signal unmap;
     } m_events;
 
+    std::optional<Region> m_configured_region;
+    Extents m_configured_extents;
+    std::optional<std::pair<Region, Extents>> m_paced_configure;
+    std::chrono::time_point<std::chrono::steady_clock> m_configure_sent;
+
+    // only places the view in a track, without touching its scene node
+    void set_scene_layer(SceneLayer layer) { m_scene_layer = layer; }
+
 private:
     Decoration m_tile_decoration;
     Decoration m_free_decoration;
@@ -230,6 +261,13 @@ private:
     bool m_iconifyable;
     bool m_iconified;
     bool m_disowned;
+    bool m_occluded;
+    bool m_opaque;
+    bool m_decoration_hidden;
+    bool m_indicated_as_next;
+    bool m_indicated_as_prev;
+    std::optional<bool> m_adaptive_sync;
+    std::optional<unsigned> m_frame_rate;
 
     std::string m_title;
     std::string m_title_formatted;
@@ -31,9 +31,10 @@ typedef struct XDGView final : public View {
     void activate(Toggle) override;
     void effectuate_fullscreen(bool) override;
 
-    void configure(Region const&, Extents const&, bool) override;
+    bool send_configure(Region const&, Extents const&) override;
     void close() override;
     void close_popups() override;
+    bool has_popups() const override;
 
     static void handle_commit(struct wl_listener*, void*);
     static void handle_request_move(struct wl_listener*, void*);
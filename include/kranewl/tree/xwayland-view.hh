@@ -38,7 +38,7 @@ typedef struct XWaylandView final : public View {
     void activate(Toggle) override;
     void effectuate_fullscreen(bool) override;
 
-    void configure(Region const&, Extents const&, bool) override;
+    bool send_configure(Region const&, Extents const&) override;
     void close() override;
     void close_popups() override;
 
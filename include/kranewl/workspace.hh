@@ -9,6 +9,7 @@
 #include <kranewl/util.hh>
 
 #include <array>
+#include <vector>
 
 typedef struct View* View_ptr;
 typedef class Output* Output_ptr;
@@ -85,6 +86,7 @@ public:
     bool focus_follows_cursor() const;
     void set_focus_follows_cursor(bool);
 
+    LayoutHandler::LayoutKind layout() const;
     bool layout_is_free() const;
     bool layout_has_margin() const;
     bool layout_has_gap() const;
@@ -105,6 +107,11 @@ public:
     std::string identifier() const;
     View_ptr active() const;
 
+    void create_scene_layers(std::array<struct wlr_scene_node*, 8> const&);
+    struct wlr_scene_node* scene_layer(SceneLayer) const;
+    bool scene_enabled() const;
+    void set_scene_enabled(bool);
+
     SceneLayer track_layer() const;
     void activate_track(SceneLayer);
     void toggle_track();
@@ -157,6 +164,7 @@ public:
     void activate_view(View_ptr);
 
     void add_view(View_ptr);
+    void adopt_view(View_ptr);
     void remove_view(View_ptr);
     void replace_view(View_ptr, View_ptr);
 
@@ -189,7 +197,8 @@ public:
 
     void toggle_layout();
     void set_layout(LayoutHandler::LayoutKind);
-    std::vector<Placement> arrange(Region) const;
+    std::vector<Placement> const& arrange(Region) const;
+    std::vector<Placement> const& placements() const { return m_placements; }
 
     std::deque<View_ptr>::iterator
     begin()
@@ -261,4 +270,12 @@ private:
 
     bool m_focus_follows_cursor;
 
+    std::array<struct wlr_scene_node*, 8> m_scene_layers;
+    bool m_scene_enabled;
+
+    mutable std::vector<View_ptr> m_arranged_views;
+    mutable std::vector<Placement> m_placements;
+
+    void forget_placement(View_ptr);
+
 }* Workspace_ptr;
@@ -1,11 +1,605 @@
 #include <version.hh>
 
+#include <kranewl/ipc.hh>
+#include <kranewl/snapshot.hh>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+extern "C" {
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+}
+
+static const std::string USAGE = "usage: kranec [...options] <command> [...arguments]\n\n"
+    "options: \n"
+    "  -t                  Prints the round trip time.\n"
+    "  -l                  Lists the available commands.\n"
+    "  -v                  Prints the version.\n"
+    "  -h                  Prints this message.";
+
+static std::string_view
+argument_name(IPC::Argument argument)
+{
+    switch (argument) {
+    case IPC::Argument::Index:      return "<index>";
+    case IPC::Argument::View:       return "<uid|focus>";
+    case IPC::Argument::Integer:    return "<integer>";
+    case IPC::Argument::Toggle:     return "<toggle>";
+    case IPC::Argument::Direction:  return "<direction>";
+    case IPC::Argument::Layout:     return "<layout>";
+    case IPC::Argument::Criterium:  return "<criterium>";
+    case IPC::Argument::SyncPolicy: return "<policy>";
+    case IPC::Argument::Events:     return "<event,...|all>";
+    case IPC::Argument::String:     return "<string...>";
+    case IPC::Argument::Commands:   return "<command> [...arguments] [; ...]";
+    default: return "";
+    }
+}
+
+static void
+list_commands()
+{
+    for (IPC::CommandSpec const& spec : IPC::COMMANDS) {
+        std::cout << spec.name;
+
+        for (IPC::Argument argument : spec.arguments)
+            if (argument != IPC::Argument::None)
+                std::cout << ' ' << argument_name(argument);
+
+        std::cout << std::endl;
+    }
+}
+
+template <std::size_t N>
+static std::optional<std::int64_t>
+parse_symbol(std::array<std::string_view, N> const& names, std::string_view arg)
+{
+    auto name = std::find(names.begin(), names.end(), arg);
+    if (name == names.end())
+        return std::nullopt;
+
+    return name - names.begin();
+}
+
+static std::optional<std::int64_t>
+parse_integer(std::string_view arg)
+{
+    std::int64_t value;
+    auto [end, error] = std::from_chars(arg.data(), arg.data() + arg.size(), value);
+
+    if (error != std::errc{} || end != arg.data() + arg.size())
+        return std::nullopt;
+
+    return value;
+}
+
+static std::optional<std::int64_t>
+parse_events(std::string_view arg)
+{
+    if (arg == "all")
+        return (std::int64_t{1} << IPC::EVENT_NAMES.size()) - 1;
+
+    std::int64_t mask = 0;
+    while (!arg.empty()) {
+        std::string_view::size_type comma = arg.find(',');
+        std::optional<std::int64_t> event = parse_symbol(IPC::EVENT_NAMES, arg.substr(0, comma));
+
+        if (!event)
+            return std::nullopt;
+
+        mask |= std::int64_t{1} << *event;
+        arg = comma == std::string_view::npos ? std::string_view{} : arg.substr(comma + 1);
+    }
+
+    return mask;
+}
+
+static std::optional<std::int64_t>
+parse_argument(IPC::Argument argument, std::string_view arg)
+{
+    switch (argument) {
+    case IPC::Argument::Index:
+    {
+        std::optional<std::int64_t> value = parse_integer(arg);
+        if (value && *value < 0)
+            return std::nullopt;
+
+        return value;
+    }
+    case IPC::Argument::View:
+    {
+        if (arg == "focus")
+            return 0;
+
+        return parse_integer(arg);
+    }
+    case IPC::Argument::Integer:    return parse_integer(arg);
+    case IPC::Argument::Toggle:     return parse_symbol(IPC::TOGGLE_NAMES, arg);
+    case IPC::Argument::Direction:  return parse_symbol(IPC::DIRECTION_NAMES, arg);
+    case IPC::Argument::Layout:     return parse_symbol(IPC::LAYOUT_NAMES, arg);
+    case IPC::Argument::Criterium:  return parse_symbol(IPC::CRITERIUM_NAMES, arg);
+    case IPC::Argument::SyncPolicy: return parse_symbol(IPC::SYNC_POLICY_NAMES, arg);
+    case IPC::Argument::Events:     return parse_events(arg);
+    default: return std::nullopt;
+    }
+}
+
+static std::optional<std::vector<char>>
+encode_command(IPC::CommandSpec const& spec, int argc, char** argv)
+{
+    std::vector<char> message(sizeof(IPC::Header));
+    int index = 0;
+
+    for (IPC::Argument argument : spec.arguments) {
+        if (argument == IPC::Argument::None)
+            continue;
+
+        if (argument == IPC::Argument::String) {
+            std::string string;
+            for (; index < argc; ++index) {
+                if (!string.empty())
+                    string += ' ';
+
+                string += argv[index];
+            }
+
+            message.insert(message.end(), string.begin(), string.end());
+            continue;
+        }
+
+        if (index >= argc) {
+            std::cerr << "kranec: " << spec.name << ": missing "
+                << argument_name(argument) << std::endl;
+            return std::nullopt;
+        }
+
+        std::optional<std::int64_t> value = parse_argument(argument, argv[index]);
+        if (!value) {
+            std::cerr << "kranec: " << spec.name << ": invalid "
+                << argument_name(argument) << " '" << argv[index] << "'" << std::endl;
+            return std::nullopt;
+        }
+
+        char const* bytes = reinterpret_cast<char const*>(&*value);
+        message.insert(message.end(), bytes, bytes + sizeof(std::int64_t));
+        ++index;
+    }
+
+    if (index < argc) {
+        std::cerr << "kranec: " << spec.name << ": too many arguments" << std::endl;
+        return std::nullopt;
+    }
+
+    if (message.size() - sizeof(IPC::Header) > IPC::MAX_PAYLOAD) {
+        std::cerr << "kranec: " << spec.name << ": arguments too long" << std::endl;
+        return std::nullopt;
+    }
+
+    IPC::Header header = {
+        .length = static_cast<std::uint32_t>(message.size() - sizeof(IPC::Header)),
+        .type = static_cast<std::uint16_t>(IPC::MessageType::Command),
+        .code = static_cast<std::uint16_t>(spec.command),
+    };
+
+    std::memcpy(message.data(), &header, sizeof(header));
+    return message;
+}
+
+static int
+connect_socket()
+{
+    std::optional<std::string> socket_path = IPC::client_socket_path();
+    if (!socket_path) {
+        std::cerr << "kranec: could not determine socket path, is kranewl running?" << std::endl;
+        return -1;
+    }
+
+    struct sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+
+    if (socket_path->size() >= sizeof(address.sun_path)) {
+        std::cerr << "kranec: socket path " << *socket_path << " is too long" << std::endl;
+        return -1;
+    }
+
+    std::memcpy(address.sun_path, socket_path->c_str(), socket_path->size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0) {
+        std::cerr << "kranec: could not connect to " << *socket_path
+            << ": " << std::strerror(errno) << std::endl;
+
+        if (fd >= 0)
+            close(fd);
+
+        return -1;
+    }
+
+    return fd;
+}
+
+static bool
+write_all(int fd, char const* data, std::size_t size)
+{
+    while (size) {
+        ssize_t length = write(fd, data, size);
+
+        if (length < 0 && errno == EINTR)
+            continue;
+
+        if (length <= 0)
+            return false;
+
+        data += length;
+        size -= length;
+    }
+
+    return true;
+}
+
+static bool
+read_all(int fd, char* data, std::size_t size)
+{
+    while (size) {
+        ssize_t length = read(fd, data, size);
+
+        if (length < 0 && errno == EINTR)
+            continue;
+
+        if (length <= 0)
+            return false;
+
+        data += length;
+        size -= length;
+    }
+
+    return true;
+}
+
+// prints one tab-separated line per event until the compositor goes away
+static int
+print_events(int fd)
+{
+    IPC::Header header;
+    std::string payload;
+
+    while (read_all(fd, reinterpret_cast<char*>(&header), sizeof(header))) {
+        if (header.length > IPC::MAX_PAYLOAD)
+            break;
+
+        payload.resize(header.length);
+        if (!read_all(fd, payload.data(), payload.size()))
+            break;
+
+        if (static_cast<IPC::MessageType>(header.type) != IPC::MessageType::Event
+            || header.code >= IPC::EVENT_NAMES.size()
+            || payload.size() < 2 * sizeof(std::int64_t))
+        {
+            continue;
+        }
+
+        std::int64_t key, value;
+        std::memcpy(&key, payload.data(), sizeof(key));
+        std::memcpy(&value, payload.data() + sizeof(key), sizeof(value));
+
+        std::string strings = payload.substr(2 * sizeof(std::int64_t));
+        std::replace(strings.begin(), strings.end(), '\0', '\t');
+
+        std::cout << IPC::EVENT_NAMES[header.code] << '\t' << key << '\t';
+
+        if (static_cast<IPC::Event>(header.code) == IPC::Event::Layout
+            && value >= 0 && static_cast<std::size_t>(value) < IPC::LAYOUT_NAMES.size())
+        {
+            std::cout << IPC::LAYOUT_NAMES[value];
+        } else
+            std::cout << value;
+
+        if (!strings.empty())
+            std::cout << '\t' << strings;
+
+        std::cout << std::endl;
+    }
+
+    close(fd);
+    return EXIT_SUCCESS;
+}
+
+static std::string_view
+status_message(IPC::Status status)
+{
+    switch (status) {
+    case IPC::Status::Ok:              return "ok";
+    case IPC::Status::UnknownCommand:  return "unknown command";
+    case IPC::Status::Malformed:       return "malformed message";
+    case IPC::Status::InvalidArgument: return "invalid argument";
+    case IPC::Status::NoSuchView:      return "no such view";
+    case IPC::Status::Unavailable:     return "unavailable";
+    default: return "unknown status";
+    }
+}
+
+static IPC::CommandSpec const*
+find_command(std::string_view name)
+{
+    auto spec = std::find_if(
+        IPC::COMMANDS.begin(),
+        IPC::COMMANDS.end(),
+        [name](IPC::CommandSpec const& spec) {
+            return spec.name == name;
+        }
+    );
+
+    if (spec == IPC::COMMANDS.end()) {
+        std::cerr << "kranec: unknown command '" << name << "'" << std::endl;
+        return nullptr;
+    }
+
+    return &*spec;
+}
+
+// commands are separated by lone ';' arguments, and each is answered with its
+// own reply ahead of the reply to the batch itself
+static std::optional<std::vector<char>>
+encode_batch(int argc, char** argv, std::size_t& command_count)
+{
+    std::vector<char> message(sizeof(IPC::Header));
+
+    for (int begin = 0, end = 0; begin < argc; begin = end + 1) {
+        for (end = begin; end < argc && std::string_view{argv[end]} != ";"; ++end);
+
+        if (begin == end)
+            continue;
+
+        IPC::CommandSpec const* spec = find_command(argv[begin]);
+        if (!spec)
+            return std::nullopt;
+
+        if (spec->command == IPC::Command::Batch || spec->command == IPC::Command::Subscribe) {
+            std::cerr << "kranec: " << spec->name << " cannot be batched" << std::endl;
+            return std::nullopt;
+        }
+
+        std::optional<std::vector<char>> command
+            = encode_command(*spec, end - begin - 1, argv + begin + 1);
+
+        if (!command)
+            return std::nullopt;
+
+        message.insert(message.end(), command->begin(), command->end());
+        ++command_count;
+    }
+
+    if (message.size() - sizeof(IPC::Header) > IPC::MAX_PAYLOAD) {
+        std::cerr << "kranec: batch: too many commands" << std::endl;
+        return std::nullopt;
+    }
+
+    IPC::Header header = {
+        .length = static_cast<std::uint32_t>(message.size() - sizeof(IPC::Header)),
+        .type = static_cast<std::uint16_t>(IPC::MessageType::Command),
+        .code = static_cast<std::uint16_t>(IPC::Command::Batch),
+    };
+
+    std::memcpy(message.data(), &header, sizeof(header));
+    return message;
+}
+
+// reads the first bytes of a reply along with any descriptor riding on them
+static bool
+read_all_with_fd(int fd, char* data, std::size_t size, int& passed_fd)
+{
+    struct iovec iov = {
+        .iov_base = data,
+        .iov_len = size,
+    };
+
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+
+    struct msghdr message = {};
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    ssize_t length;
+    while ((length = recvmsg(fd, &message, MSG_CMSG_CLOEXEC)) < 0 && errno == EINTR);
+
+    if (length <= 0)
+        return false;
+
+    for (struct cmsghdr* header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header))
+        if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS)
+            std::memcpy(&passed_fd, CMSG_DATA(header), sizeof(int));
+
+    return read_all(fd, data + length, size - length);
+}
+
+static int
+print_snapshot(int fd)
+{
+    void* memory = mmap(nullptr, sizeof(IPC::Snapshot), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (memory == MAP_FAILED) {
+        std::cerr << "kranec: could not map snapshot: " << std::strerror(errno) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    IPC::Snapshot const* snapshot = static_cast<IPC::Snapshot const*>(memory);
+    IPC::Snapshot::State state;
+
+    if (snapshot->magic != IPC::SNAPSHOT_MAGIC
+        || snapshot->version != IPC::SNAPSHOT_VERSION
+        || !IPC::read_snapshot(snapshot, state))
+    {
+        std::cerr << "kranec: could not read snapshot" << std::endl;
+        munmap(memory, sizeof(IPC::Snapshot));
+        return EXIT_FAILURE;
+    }
+
+    munmap(memory, sizeof(IPC::Snapshot));
+
+    auto index = [](std::uint32_t index) -> std::string {
+        return index == IPC::SNAPSHOT_NONE ? "-" : std::to_string(index);
+    };
+
+    std::cout << "output\t" << index(state.output) << std::endl
+        << "context\t" << index(state.context) << std::endl
+        << "workspace\t" << index(state.workspace) << std::endl
+        << "focus\t" << state.focus
+        << '\t' << state.focus_app_id
+        << '\t' << state.focus_title << std::endl;
+
+    for (std::uint32_t i = 0; i < state.workspace_count; ++i)
+        if (state.workspaces[i].view_count || i == state.workspace)
+            std::cout << "workspace\t" << i
+                << '\t' << state.workspaces[i].view_count
+                << '\t' << (state.workspaces[i].layout < IPC::LAYOUT_NAMES.size()
+                    ? IPC::LAYOUT_NAMES[state.workspaces[i].layout]
+                    : "-")
+                << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
+static bool
+read_reply(
+    int fd,
+    IPC::Header& header,
+    IPC::Status& status,
+    std::string& message,
+    int& passed_fd
+)
+{
+    if (!read_all_with_fd(fd, reinterpret_cast<char*>(&header), sizeof(header), passed_fd)
+        || header.length < sizeof(status)
+        || header.length > IPC::MAX_PAYLOAD + sizeof(status)
+        || !read_all(fd, reinterpret_cast<char*>(&status), sizeof(status)))
+    {
+        return false;
+    }
+
+    message.resize(header.length - sizeof(status));
+    return read_all(fd, message.data(), message.size());
+}
+
 int
 main(int argc, char** argv)
 {
-    // TODO
-    (void)argc;
-    (void)argv;
+    bool timed = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "+tlvh")) != -1) {
+        switch (opt) {
+        case 't': timed = true; break;
+        case 'l': list_commands(); return EXIT_SUCCESS;
+        case 'v': std::cout << VERSION << std::endl; return EXIT_SUCCESS;
+        case 'h': std::cout << USAGE << std::endl; return EXIT_SUCCESS;
+        default: std::cerr << USAGE << std::endl; return EXIT_FAILURE;
+        }
+    }
+
+    if (optind >= argc) {
+        std::cerr << USAGE << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    IPC::CommandSpec const* spec = find_command(argv[optind]);
+    if (!spec)
+        return EXIT_FAILURE;
+
+    std::size_t reply_count = 1;
+    std::optional<std::vector<char>> message
+        = spec->command == IPC::Command::Batch
+            ? encode_batch(argc - optind - 1, argv + optind + 1, reply_count)
+            : encode_command(*spec, argc - optind - 1, argv + optind + 1);
+
+    if (!message)
+        return EXIT_FAILURE;
+
+    int fd = connect_socket();
+    if (fd < 0)
+        return EXIT_FAILURE;
+
+    // the whole command goes out in a single write, so that the compositor
+    // can answer it from a single wakeup
+    auto sent = std::chrono::steady_clock::now();
+
+    if (!write_all(fd, message->data(), message->size())) {
+        std::cerr << "kranec: lost connection to kranewl" << std::endl;
+        close(fd);
+        return EXIT_FAILURE;
+    }
+
+    bool failed = false;
+    int passed_fd = -1;
+
+    for (std::size_t i = 0; i < reply_count; ++i) {
+        IPC::Header header;
+        IPC::Status status;
+        std::string reply;
+
+        if (!read_reply(fd, header, status, reply, passed_fd)) {
+            std::cerr << "kranec: lost connection to kranewl" << std::endl;
+            close(fd);
+            return EXIT_FAILURE;
+        }
+
+        if (!reply.empty())
+            std::cout << reply << std::endl;
+
+        if (status != IPC::Status::Ok) {
+            IPC::CommandSpec const* reply_spec = IPC::command_spec(header.code);
+
+            std::cerr << "kranec: " << (reply_spec ? reply_spec->name : spec->name)
+                << ": " << status_message(status) << std::endl;
+
+            failed = true;
+        }
+
+        // a malformed batch is cut short, its own reply arriving early
+        if (static_cast<IPC::Command>(header.code) == IPC::Command::Batch)
+            break;
+    }
+
+    auto received = std::chrono::steady_clock::now();
+
+    if (timed)
+        std::cerr << "kranec: round trip took "
+            << std::chrono::duration_cast<std::chrono::microseconds>(received - sent).count()
+            << "us" << std::endl;
+
+    if (failed) {
+        close(fd);
+        return EXIT_FAILURE;
+    }
+
+    if (spec->command == IPC::Command::Subscribe)
+        return print_events(fd);
+
+    close(fd);
+
+    if (spec->command == IPC::Command::Snapshot) {
+        if (passed_fd < 0) {
+            std::cerr << "kranec: snapshot: no descriptor received" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        return print_snapshot(passed_fd);
+    }
 
-    return 0;
+    return EXIT_SUCCESS;
 }
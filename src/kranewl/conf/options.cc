@@ -78,11 +78,9 @@ resolve_rules_path(std::string& path) noexcept
         if (assert_permissions(path, R_OK))
             return path;
 
+    // kept even when absent, so that a rules file created later is picked up
     path.assign(default_user_path("rules"));
-    if (assert_permissions(path, R_OK))
-        return {path};
-
-    return {};
+    return {path};
 }
 
 static std::optional<std::string>
@@ -0,0 +1,47 @@
+#include <trace.hh>
+
+#include <kranewl/context.hh>
+
+// https://github.com/swaywm/wlroots/issues/682
+#include <pthread.h>
+#define class class_
+#define namespace namespace_
+#define static
+extern "C" {
+#include <wlr/types/wlr_scene.h>
+}
+#undef static
+#undef namespace
+#undef class
+
+void
+Context::create_scene_layers(std::array<struct wlr_scene_node*, 8> const& scene_layers)
+{
+    TRACE();
+
+    for (std::size_t i = 0; i < scene_layers.size(); ++i) {
+        m_scene_layers[i] = &wlr_scene_tree_create(scene_layers[i])->node;
+        wlr_scene_node_set_enabled(m_scene_layers[i], m_scene_enabled);
+    }
+}
+
+struct wlr_scene_node*
+Context::scene_layer(SceneLayer layer) const
+{
+    return m_scene_layers[layer];
+}
+
+void
+Context::set_scene_enabled(bool enabled)
+{
+    TRACE();
+
+    if (enabled == m_scene_enabled)
+        return;
+
+    m_scene_enabled = enabled;
+
+    for (struct wlr_scene_node* scene_layer : m_scene_layers)
+        if (scene_layer)
+            wlr_scene_node_set_enabled(scene_layer, enabled);
+}
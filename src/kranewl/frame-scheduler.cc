@@ -0,0 +1,183 @@
+#include <trace.hh>
+
+#include <kranewl/frame-scheduler.hh>
+
+#include <kranewl/server.hh>
+#include <kranewl/tree/output.hh>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <ctime>
+
+static inline std::uint64_t
+monotonic_now()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return static_cast<std::uint64_t>(now.tv_sec) * 1'000'000'000
+        + static_cast<std::uint64_t>(now.tv_nsec);
+}
+
+FrameScheduler::FrameScheduler(Server_ptr server, Output_ptr output)
+    : mp_server(server),
+      mp_output(output),
+      m_mode(Mode::Adaptive),
+      m_max_render_time(0),
+      m_samples({}),
+      m_sample_index(0),
+      m_sample_count(0),
+      m_last_present(0),
+      m_refresh(0),
+      m_scheduled(false),
+      mp_render_source(nullptr)
+{}
+
+FrameScheduler::~FrameScheduler()
+{
+    if (mp_render_source)
+        wl_event_source_remove(mp_render_source);
+}
+
+void
+FrameScheduler::set_mode(Mode mode, std::chrono::microseconds max_render_time)
+{
+    TRACE();
+
+    if (mode == Mode::Fixed && max_render_time <= std::chrono::microseconds(0))
+        mode = Mode::Immediate;
+
+    m_mode = mode;
+    m_max_render_time = max_render_time;
+    m_sample_index = 0;
+    m_sample_count = 0;
+}
+
+void
+FrameScheduler::schedule()
+{
+    TRACE();
+
+    if (m_scheduled)
+        return;
+
+    std::uint64_t refresh = refresh_period();
+    if (m_mode == Mode::Immediate || !refresh || !m_last_present) {
+        mp_output->render();
+        return;
+    }
+
+    std::uint64_t now = monotonic_now();
+    std::uint64_t budget = std::chrono::nanoseconds(render_budget()).count();
+
+    // predict the upcoming vblank from the most recent presentation timestamp
+    std::uint64_t vblank = m_last_present + refresh;
+    if (vblank <= now)
+        vblank += ((now - vblank) / refresh + 1) * refresh;
+
+    if (vblank <= now + budget) {
+        mp_output->render();
+        return;
+    }
+
+    // timers only have millisecond granularity, so round the delay down and
+    // rather start rendering early than risk missing the vblank altogether
+    std::chrono::milliseconds delay = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::nanoseconds(vblank - now - budget)
+    );
+
+    if (delay < MIN_DELAY) {
+        mp_output->render();
+        return;
+    }
+
+    if (!mp_render_source)
+        mp_render_source = wl_event_loop_add_timer(
+            mp_server->mp_event_loop,
+            FrameScheduler::handle_render,
+            this
+        );
+
+    if (!mp_render_source
+        || wl_event_source_timer_update(mp_render_source, delay.count()) < 0)
+    {
+        spdlog::error("Could not arm render timer, rendering immediately");
+        mp_output->render();
+        return;
+    }
+
+    m_scheduled = true;
+}
+
+void
+FrameScheduler::record_commit(std::uint64_t duration)
+{
+    m_samples[m_sample_index] = duration;
+    m_sample_index = (m_sample_index + 1) % SAMPLE_COUNT;
+    m_sample_count = std::min(m_sample_count + 1, SAMPLE_COUNT);
+}
+
+void
+FrameScheduler::record_present(std::uint64_t when, int refresh)
+{
+    m_last_present = when;
+
+    if (refresh > 0)
+        m_refresh = static_cast<std::uint64_t>(refresh);
+}
+
+std::chrono::microseconds
+FrameScheduler::render_budget() const
+{
+    switch (m_mode) {
+    case Mode::Immediate: break;
+    case Mode::Fixed: return m_max_render_time;
+    case Mode::Adaptive:
+    {
+        if (!m_sample_count)
+            break;
+
+        // budget for the slowest recent commit with some headroom, such that
+        // a single slow frame widens the window until it ages out again
+        std::uint64_t slowest = *std::max_element(
+            m_samples.begin(),
+            m_samples.begin() + m_sample_count
+        );
+
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::nanoseconds(slowest + slowest / 4)
+        ) + SLACK;
+    }
+    }
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::nanoseconds(refresh_period())
+    );
+}
+
+int
+FrameScheduler::handle_render(void* data)
+{
+    TRACE();
+
+    FrameScheduler_ptr scheduler = reinterpret_cast<FrameScheduler_ptr>(data);
+
+    scheduler->m_scheduled = false;
+    scheduler->mp_output->render();
+
+    return 0;
+}
+
+std::uint64_t
+FrameScheduler::refresh_period() const
+{
+    if (m_refresh)
+        return m_refresh;
+
+    // fall back to the nominal refresh rate of the current mode (in mHz)
+    int refresh = mp_output->mp_wlr_output->refresh;
+    return refresh > 0
+        ? 1'000'000'000'000 / static_cast<std::uint64_t>(refresh)
+        : 0;
+}
@@ -6,10 +6,13 @@
 #include <kranewl/model.hh>
 #include <kranewl/scene-layer.hh>
 #include <kranewl/server.hh>
+#include <kranewl/spatial-index.hh>
 #include <kranewl/tree/view.hh>
 #include <kranewl/util.hh>
 #include <kranewl/workspace.hh>
 
+#include <spdlog/spdlog.h>
+
 // https://github.com/swaywm/wlroots/issues/682
 #include <pthread.h>
 #define class class_
@@ -19,6 +22,7 @@ extern "C" {
 #include <wlr/types/wlr_cursor.h>
 #include <wlr/types/wlr_data_device.h>
 #include <wlr/types/wlr_idle.h>
+#include <wlr/types/wlr_output_layout.h>
 #include <wlr/types/wlr_pointer_gestures_v1.h>
 #include <wlr/types/wlr_scene.h>
 #include <wlr/types/wlr_seat.h>
@@ -29,6 +33,7 @@ extern "C" {
 #undef class
 
 #include <algorithm>
+#include <cmath>
 
 Cursor::Cursor(
     Server_ptr server,
@@ -42,6 +47,17 @@ Cursor::Cursor(
       mp_wlr_cursor(cursor),
       mp_cursor_manager(wlr_xcursor_manager_create(nullptr, 24)),
       mp_pointer_gestures(wlr_pointer_gestures_v1_create(server->mp_display)),
+      m_motion_pending(false),
+      m_motion_time(0),
+      m_idle_notify_time(0),
+      mp_hovered_view(nullptr),
+      mp_focused_by_cursor(nullptr),
+      m_focus_pending(false),
+      mp_focus_source(wl_event_loop_add_timer(
+          server->mp_event_loop,
+          Cursor::handle_focus_timeout,
+          this
+      )),
       ml_cursor_motion({ .notify = Cursor::handle_cursor_motion }),
       ml_cursor_motion_absolute({ .notify = Cursor::handle_cursor_motion_absolute }),
       ml_cursor_button({ .notify = Cursor::handle_cursor_button }),
@@ -80,13 +96,42 @@ Cursor::Cursor(
 
 Cursor::~Cursor()
 {
+    wl_event_source_remove(mp_focus_source);
     wlr_xcursor_manager_destroy(mp_cursor_manager);
     wlr_cursor_destroy(mp_wlr_cursor);
 }
 
+static inline bool
+scene_node_visible(struct wlr_scene_node* node)
+{
+    for (; node; node = node->parent)
+        if (!node->state.enabled)
+            return false;
+
+    return true;
+}
+
+static inline Node_ptr
+node_from_scene_node(struct wlr_scene_node* node, struct wlr_surface** surface)
+{
+    if (node->type != WLR_SCENE_NODE_SURFACE)
+        return nullptr;
+
+    *surface = wlr_scene_surface_from_node(node)->surface;
+
+    while (node && !node->data)
+        node = node->parent;
+
+    if (node && node->data)
+        return reinterpret_cast<Node_ptr>(node->data);
+
+    return nullptr;
+}
+
 static inline Node_ptr
 node_at(
     Server_ptr server,
+    SpatialIndex& spatial_index,
     double lx, double ly,
     struct wlr_surface** surface,
     double* sx, double* sy
@@ -100,22 +145,63 @@ node_at(
         SCENE_LAYER_BOTTOM,
     };
 
-    struct wlr_scene_node* node;
-    for (auto const& layer : focus_order) {
-        if ((node = wlr_scene_node_at(server->m_scene_layers[layer], lx, ly, sx, sy))) {
-            if (node->type != WLR_SCENE_NODE_SURFACE)
-                return nullptr;
+    static std::vector<SpatialIndex::Entry const*> entries = {};
+    static std::vector<Node_ptr> bounded = {};
 
-            *surface = wlr_scene_surface_from_node(node)->surface;
+    Pos pos = Pos{
+        .x = static_cast<int>(std::floor(lx)),
+        .y = static_cast<int>(std::floor(ly))
+    };
 
-            while (node && !node->data)
-                node = node->parent;
+    spatial_index.query(pos, entries);
 
-            if (node && node->data)
-                return reinterpret_cast<Node_ptr>(node->data);
+    // views whose popups have since been dismissed are no longer unbounded
+    bounded.clear();
+    for (SpatialIndex::Entry const* entry : entries)
+        if (entry->unbounded && entry->node->is_view()
+                && !reinterpret_cast<View_ptr>(entry->node)->has_popups())
+            bounded.push_back(entry->node);
 
-            return nullptr;
+    if (!bounded.empty()) {
+        for (Node_ptr node : bounded)
+            spatial_index.set_unbounded(node, false);
+
+        spatial_index.query(pos, entries);
+    }
+
+    for (auto const& layer : focus_order) {
+        SpatialIndex::Entry const* candidate = nullptr;
+        std::size_t candidate_count = 0;
+
+        for (SpatialIndex::Entry const* entry : entries)
+            if (entry->layer == layer && scene_node_visible(entry->scene)) {
+                candidate = entry;
+                ++candidate_count;
+            }
+
+        struct wlr_scene_node* node;
+        switch (candidate_count) {
+        case 0: continue;
+        case 1:
+        {
+            // only the candidate's own subtree has to be tested exactly
+            int px = 0, py = 0;
+            if (candidate->scene->parent)
+                wlr_scene_node_coords(candidate->scene->parent, &px, &py);
+
+            node = wlr_scene_node_at(candidate->scene, lx - px, ly - py, sx, sy);
+            break;
+        }
+        default:
+        {
+            // overlapping candidates, defer to the scene graph for stacking order
+            node = wlr_scene_node_at(server->m_scene_layers[layer], lx, ly, sx, sy);
+            break;
+        }
         }
+
+        if (node)
+            return node_from_scene_node(node, surface);
     }
 
     return nullptr;
@@ -124,12 +210,13 @@ node_at(
 static inline View_ptr
 view_at(
     Server_ptr server,
+    SpatialIndex& spatial_index,
     double lx, double ly,
     struct wlr_surface** surface,
     double* sx, double* sy
 )
 {
-    Node_ptr node = node_at(server, lx, ly, surface, sx, sy);
+    Node_ptr node = node_at(server, spatial_index, lx, ly, surface, sx, sy);
 
     if (node && node->is_view())
         return reinterpret_cast<View_ptr>(node);
@@ -160,6 +247,7 @@ Cursor::node_under_cursor() const
 
     Node_ptr node = node_at(
         mp_server,
+        mp_model->spatial_index(),
         mp_wlr_cursor->x,
         mp_wlr_cursor->y,
         &surface,
@@ -169,6 +257,20 @@ Cursor::node_under_cursor() const
     return node;
 }
 
+Output_ptr
+Cursor::output_under_cursor() const
+{
+    struct wlr_output* wlr_output = wlr_output_layout_output_at(
+        mp_server->mp_output_layout,
+        mp_wlr_cursor->x,
+        mp_wlr_cursor->y
+    );
+
+    return wlr_output
+        ? reinterpret_cast<Output_ptr>(wlr_output->data)
+        : nullptr;
+}
+
 View_ptr
 Cursor::view_under_cursor() const
 {
@@ -177,6 +279,7 @@ Cursor::view_under_cursor() const
 
     View_ptr view = view_at(
         mp_server,
+        mp_model->spatial_index(),
         mp_wlr_cursor->x,
         mp_wlr_cursor->y,
         &surface,
@@ -397,19 +500,33 @@ cursor_motion_to_client(
     uint32_t time
 )
 {
-    static View_ptr prev_view = nullptr;
-
     if (time) {
-        wlr_idle_notify_activity(
-            cursor->mp_seat->mp_idle,
-            cursor->mp_seat->mp_wlr_seat
-        );
-
-        if (view && view != prev_view && view->belongs_to_active_track()
-            && view->mp_workspace->focus_follows_cursor() && view->managed())
+        if (time - cursor->m_idle_notify_time
+                >= static_cast<uint32_t>(Cursor::IDLE_NOTIFY_INTERVAL.count()))
         {
-            cursor->mp_seat->mp_model->focus_view(view);
-            prev_view = view;
+            wlr_idle_notify_activity(
+                cursor->mp_seat->mp_idle,
+                cursor->mp_seat->mp_wlr_seat
+            );
+
+            cursor->m_idle_notify_time = time;
+        }
+
+        // focus is only passed on once the cursor has settled on a view, so
+        // that sweeping across several views does not relayout for each one
+        if (view != cursor->mp_hovered_view) {
+            cursor->mp_hovered_view = view;
+
+            if (view && view != cursor->mp_focused_by_cursor) {
+                if (wl_event_source_timer_update(
+                    cursor->mp_focus_source,
+                    Cursor::FOCUS_DELAY.count()
+                ) < 0)
+                {
+                    spdlog::error("Could not arm cursor focus timer");
+                } else
+                    cursor->m_focus_pending = true;
+            }
         }
     }
 
@@ -451,6 +568,7 @@ Cursor::process_cursor_motion(uint32_t time)
 
     View_ptr view = view_at(
         mp_server,
+        mp_model->spatial_index(),
         mp_wlr_cursor->x,
         mp_wlr_cursor->y,
         &surface,
@@ -467,6 +585,76 @@ Cursor::process_cursor_motion(uint32_t time)
     cursor_motion_to_client(this, view, surface, sx, sy, time);
 }
 
+void
+Cursor::flush_cursor_motion()
+{
+    if (!m_motion_pending)
+        return;
+
+    m_motion_pending = false;
+    process_cursor_motion(m_motion_time);
+}
+
+void
+Cursor::flush_cursor_focus()
+{
+    TRACE();
+
+    if (!m_focus_pending)
+        return;
+
+    if (wl_event_source_timer_update(mp_focus_source, 0) < 0)
+        spdlog::error("Could not disarm cursor focus timer");
+
+    m_focus_pending = false;
+
+    View_ptr view = view_under_cursor();
+    if (view && view->belongs_to_active_track()
+        && view->mp_workspace->focus_follows_cursor() && view->managed())
+    {
+        mp_focused_by_cursor = view;
+
+        if (!view->focused())
+            mp_seat->mp_model->focus_view(view);
+    }
+}
+
+void
+Cursor::forget_view(View_ptr view)
+{
+    TRACE();
+
+    if (m_grab_state.view == view)
+        abort_cursor_interactive();
+
+    if (mp_focused_by_cursor == view)
+        mp_focused_by_cursor = nullptr;
+
+    if (mp_hovered_view != view)
+        return;
+
+    mp_hovered_view = nullptr;
+
+    // the pending focus was meant for the view that is going away
+    if (m_focus_pending) {
+        if (wl_event_source_timer_update(mp_focus_source, 0) < 0)
+            spdlog::error("Could not disarm cursor focus timer");
+
+        m_focus_pending = false;
+    }
+}
+
+int
+Cursor::handle_focus_timeout(void* data)
+{
+    TRACE();
+
+    Cursor_ptr cursor = reinterpret_cast<Cursor_ptr>(data);
+    cursor->flush_cursor_focus();
+
+    return 0;
+}
+
 void
 Cursor::handle_cursor_motion(struct wl_listener* listener, void* data)
 {
@@ -475,7 +663,10 @@ Cursor::handle_cursor_motion(struct wl_listener* listener, void* data)
         = reinterpret_cast<struct wlr_event_pointer_motion*>(data);
 
     wlr_cursor_move(cursor->mp_wlr_cursor, event->device, event->delta_x, event->delta_y);
-    cursor->process_cursor_motion(event->time_msec);
+    cursor->mp_model->register_input(event->time_msec, cursor->output_under_cursor());
+
+    cursor->m_motion_pending = true;
+    cursor->m_motion_time = event->time_msec;
 }
 
 void
@@ -486,7 +677,10 @@ Cursor::handle_cursor_motion_absolute(struct wl_listener* listener, void* data)
         = reinterpret_cast<struct wlr_event_pointer_motion_absolute*>(data);
 
     wlr_cursor_warp_absolute(cursor->mp_wlr_cursor, event->device, event->x, event->y);
-    cursor->process_cursor_motion(event->time_msec);
+    cursor->mp_model->register_input(event->time_msec, cursor->output_under_cursor());
+
+    cursor->m_motion_pending = true;
+    cursor->m_motion_time = event->time_msec;
 }
 
 static inline bool
@@ -554,6 +748,10 @@ Cursor::handle_cursor_button(struct wl_listener* listener, void* data)
     struct wlr_event_pointer_button* event
         = reinterpret_cast<struct wlr_event_pointer_button*>(data);
 
+    cursor->mp_model->register_input(event->time_msec, cursor->output_under_cursor());
+    cursor->flush_cursor_motion();
+    cursor->flush_cursor_focus();
+
     wlr_idle_notify_activity(
         cursor->mp_seat->mp_idle,
         cursor->mp_seat->mp_wlr_seat
@@ -586,6 +784,9 @@ Cursor::handle_cursor_button(struct wl_listener* listener, void* data)
     case WLR_BUTTON_RELEASED:
     {
         if (cursor->m_cursor_mode != Mode::Passthrough) {
+            if (cursor->m_grab_state.view)
+                cursor->m_grab_state.view->flush_paced_configure();
+
             cursor->m_cursor_mode = Mode::Passthrough;
 
             wlr_xcursor_manager_set_cursor_image(
@@ -618,6 +819,9 @@ Cursor::handle_cursor_axis(struct wl_listener* listener, void* data)
     struct wlr_event_pointer_axis* event
         = reinterpret_cast<struct wlr_event_pointer_axis*>(data);
 
+    cursor->mp_model->register_input(event->time_msec, cursor->output_under_cursor());
+    cursor->flush_cursor_motion();
+
     struct wlr_keyboard* keyboard
         = wlr_seat_get_keyboard(seat->mp_wlr_seat);
 
@@ -661,6 +865,8 @@ void
 Cursor::handle_cursor_frame(struct wl_listener* listener, void*)
 {
     Cursor_ptr cursor = wl_container_of(listener, cursor, ml_cursor_frame);
+
+    cursor->flush_cursor_motion();
     wlr_seat_pointer_notify_frame(cursor->mp_seat->mp_wlr_seat);
 }
 
@@ -110,6 +110,8 @@ Keyboard::handle_key(struct wl_listener* listener, void* data)
         seat->mp_wlr_seat
     );
 
+    seat->mp_model->register_input(event->time_msec);
+
     bool key_press_handled = false;
     switch (event->state) {
     case WL_KEYBOARD_KEY_STATE_PRESSED:
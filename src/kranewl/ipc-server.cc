@@ -0,0 +1,911 @@
+#include <trace.hh>
+
+#include <kranewl/ipc-server.hh>
+
+#include <kranewl/context.hh>
+#include <kranewl/model.hh>
+#include <kranewl/search.hh>
+#include <kranewl/server.hh>
+#include <kranewl/tree/output.hh>
+#include <kranewl/tree/view.hh>
+#include <kranewl/util.hh>
+#include <kranewl/workspace.hh>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+extern "C" {
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+}
+
+IPCServer::IPCServer(Server_ptr server, Model_ptr model)
+    : mp_server(server),
+      mp_model(model),
+      m_socket_path({}),
+      m_socket_fd(-1),
+      mp_socket_source(nullptr),
+      m_clients({}),
+      m_subscriptions(0),
+      mp_deliver_source(nullptr)
+{}
+
+IPCServer::~IPCServer()
+{
+    TRACE();
+
+    for (Client_ptr client : m_clients) {
+        wl_event_source_remove(client->source);
+        close(client->fd);
+        delete client;
+    }
+
+    if (mp_deliver_source)
+        wl_event_source_remove(mp_deliver_source);
+
+    if (mp_socket_source)
+        wl_event_source_remove(mp_socket_source);
+
+    if (m_socket_fd >= 0) {
+        close(m_socket_fd);
+        unlink(m_socket_path.c_str());
+    }
+}
+
+bool
+IPCServer::listen(std::string const& display)
+{
+    TRACE();
+
+    std::optional<std::string> socket_path = IPC::socket_path(display.c_str());
+    if (!socket_path) {
+        spdlog::error("Could not determine IPC socket path, XDG_RUNTIME_DIR is unset");
+        return false;
+    }
+
+    struct sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+
+    if (socket_path->size() >= sizeof(address.sun_path)) {
+        spdlog::error("IPC socket path {} is too long", *socket_path);
+        return false;
+    }
+
+    std::memcpy(address.sun_path, socket_path->c_str(), socket_path->size() + 1);
+
+    m_socket_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_socket_fd < 0) {
+        spdlog::error("Could not create IPC socket: {}", std::strerror(errno));
+        return false;
+    }
+
+    // a previous instance on the same display may have left its socket behind
+    unlink(socket_path->c_str());
+
+    if (bind(m_socket_fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0
+        || chmod(socket_path->c_str(), S_IRUSR | S_IWUSR) < 0
+        || ::listen(m_socket_fd, SOMAXCONN) < 0)
+    {
+        spdlog::error("Could not bind IPC socket {}: {}", *socket_path, std::strerror(errno));
+        close(m_socket_fd);
+        m_socket_fd = -1;
+        return false;
+    }
+
+    m_socket_path = *socket_path;
+    mp_socket_source = wl_event_loop_add_fd(
+        mp_server->mp_event_loop,
+        m_socket_fd,
+        WL_EVENT_READABLE,
+        IPCServer::handle_socket,
+        this
+    );
+
+    setenv("KRANEWL_SOCKET", m_socket_path.c_str(), true);
+    spdlog::info("Listening for IPC clients at KRANEWL_SOCKET={}", m_socket_path);
+
+    return true;
+}
+
+int
+IPCServer::handle_socket(int, uint32_t, void* data)
+{
+    TRACE();
+
+    IPCServer_ptr ipc_server = reinterpret_cast<IPCServer_ptr>(data);
+    ipc_server->accept_clients();
+
+    return 0;
+}
+
+int
+IPCServer::handle_client(int, uint32_t mask, void* data)
+{
+    TRACE();
+
+    Client_ptr client = reinterpret_cast<Client_ptr>(data);
+    IPCServer_ptr ipc_server = client->ipc_server;
+
+    if ((mask & WL_EVENT_READABLE) && !ipc_server->receive(client)) {
+        ipc_server->disconnect(client);
+        return 0;
+    }
+
+    if ((mask & WL_EVENT_WRITABLE) && !ipc_server->flush(client)) {
+        ipc_server->disconnect(client);
+        return 0;
+    }
+
+    if (mask & (WL_EVENT_HANGUP | WL_EVENT_ERROR))
+        ipc_server->disconnect(client);
+
+    return 0;
+}
+
+void
+IPCServer::accept_clients()
+{
+    TRACE();
+
+    int fd;
+    while ((fd = accept4(m_socket_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        Client_ptr client = new Client{
+            .ipc_server = this,
+            .fd = fd,
+            .source = nullptr,
+            .input = {},
+            .output = {},
+            .output_fds = {},
+            .subscriptions = 0,
+            .events = {},
+            .events_head = 0,
+            .events_size = 0,
+        };
+
+        client->source = wl_event_loop_add_fd(
+            mp_server->mp_event_loop,
+            fd,
+            WL_EVENT_READABLE,
+            IPCServer::handle_client,
+            client
+        );
+
+        if (!client->source) {
+            spdlog::error("Could not register IPC client");
+            close(fd);
+            delete client;
+            continue;
+        }
+
+        m_clients.push_back(client);
+    }
+
+    if (errno != EAGAIN && errno != EWOULDBLOCK)
+        spdlog::error("Could not accept IPC client: {}", std::strerror(errno));
+}
+
+void
+IPCServer::disconnect(Client_ptr client)
+{
+    TRACE();
+
+    Util::erase_remove(m_clients, client);
+    wl_event_source_remove(client->source);
+    close(client->fd);
+
+    if (client->subscriptions)
+        subscribe(client, 0);
+
+    delete client;
+}
+
+bool
+IPCServer::receive(Client_ptr client)
+{
+    TRACE();
+
+    char buffer[4096];
+    ssize_t length;
+
+    for (;;) {
+        length = read(client->fd, buffer, sizeof(buffer));
+
+        if (length > 0) {
+            client->input.insert(client->input.end(), buffer, buffer + length);
+            continue;
+        }
+
+        if (length == 0)
+            return false;
+
+        if (errno == EINTR)
+            continue;
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            break;
+
+        return false;
+    }
+
+    // every complete message is answered before a single flush, so that
+    // pipelined commands cost one write on the way back
+    std::size_t offset = 0;
+    while (client->input.size() - offset >= sizeof(IPC::Header)) {
+        IPC::Header header;
+        std::memcpy(&header, client->input.data() + offset, sizeof(header));
+
+        if (header.length > IPC::MAX_PAYLOAD) {
+            spdlog::warn("Dropping IPC client sending an oversized message");
+            return false;
+        }
+
+        if (client->input.size() - offset - sizeof(header) < header.length)
+            break;
+
+        dispatch(client, header, client->input.data() + offset + sizeof(header));
+        offset += sizeof(header) + header.length;
+    }
+
+    client->input.erase(client->input.begin(), client->input.begin() + offset);
+    return flush(client);
+}
+
+void
+IPCServer::dispatch(Client_ptr client, IPC::Header const& header, char const* payload)
+{
+    TRACE();
+
+    IPC::CommandSpec const* spec = IPC::command_spec(header.code);
+    IPC::Command command = static_cast<IPC::Command>(header.code);
+
+    if (static_cast<IPC::MessageType>(header.type) != IPC::MessageType::Command || !spec) {
+        reply(client, command, IPC::Status::UnknownCommand);
+        return;
+    }
+
+    if (spec->command == IPC::Command::Batch) {
+        dispatch_batch(client, header, payload);
+        return;
+    }
+
+    std::int64_t integers[IPC::MAX_ARGUMENTS] = {};
+    std::size_t integer_count = 0;
+    std::size_t offset = 0;
+    bool has_string = false;
+
+    for (IPC::Argument argument : spec->arguments)
+        switch (argument) {
+        case IPC::Argument::None: break;
+        case IPC::Argument::String: has_string = true; break;
+        default:
+            if (header.length - offset < sizeof(std::int64_t)) {
+                reply(client, command, IPC::Status::Malformed);
+                return;
+            }
+
+            std::memcpy(&integers[integer_count++], payload + offset, sizeof(std::int64_t));
+            offset += sizeof(std::int64_t);
+            break;
+        }
+
+    if (!has_string && offset != header.length) {
+        reply(client, command, IPC::Status::Malformed);
+        return;
+    }
+
+    // the snapshot descriptor is attached to the first byte of the reply
+    if (spec->command == IPC::Command::Snapshot) {
+        int fd = mp_model->snapshot_fd();
+
+        if (fd >= 0)
+            client->output_fds.emplace_back(client->output.size(), fd);
+
+        reply(client, command, fd >= 0 ? IPC::Status::Ok : IPC::Status::Unavailable);
+        return;
+    }
+
+    std::string message;
+    IPC::Status status = execute(
+        client,
+        *spec,
+        integers,
+        has_string ? std::string(payload + offset, header.length - offset) : std::string{},
+        message
+    );
+
+    reply(client, command, status, message);
+}
+
+void
+IPCServer::dispatch_batch(Client_ptr client, IPC::Header const& header, char const* payload)
+{
+    TRACE();
+
+    IPC::Status status = IPC::Status::Ok;
+    std::size_t offset = 0;
+
+    // every workspace the batch dirties is arranged once, on commit
+    mp_model->begin_batch();
+
+    while (offset < header.length) {
+        IPC::Header command_header;
+
+        if (header.length - offset < sizeof(command_header)) {
+            status = IPC::Status::Malformed;
+            break;
+        }
+
+        std::memcpy(&command_header, payload + offset, sizeof(command_header));
+        offset += sizeof(command_header);
+
+        if (header.length - offset < command_header.length
+            || command_header.code == static_cast<std::uint16_t>(IPC::Command::Batch))
+        {
+            status = IPC::Status::Malformed;
+            break;
+        }
+
+        dispatch(client, command_header, payload + offset);
+        offset += command_header.length;
+    }
+
+    mp_model->commit_batch();
+    reply(client, IPC::Command::Batch, status);
+}
+
+void
+IPCServer::reply(
+    Client_ptr client,
+    IPC::Command command,
+    IPC::Status status,
+    std::string const& message
+)
+{
+    IPC::Header header = {
+        .length = static_cast<std::uint32_t>(sizeof(IPC::Status) + message.size()),
+        .type = static_cast<std::uint16_t>(IPC::MessageType::Reply),
+        .code = static_cast<std::uint16_t>(command),
+    };
+
+    char const* header_bytes = reinterpret_cast<char const*>(&header);
+    char const* status_bytes = reinterpret_cast<char const*>(&status);
+
+    client->output.insert(client->output.end(), header_bytes, header_bytes + sizeof(header));
+    client->output.insert(client->output.end(), status_bytes, status_bytes + sizeof(status));
+    client->output.insert(client->output.end(), message.begin(), message.end());
+}
+
+bool
+IPCServer::flush(Client_ptr client)
+{
+    TRACE();
+
+    std::size_t written = 0;
+    for (;;) {
+        serialize_events(client, written);
+
+        if (written == client->output.size())
+            break;
+
+        struct iovec iov = {
+            .iov_base = client->output.data() + written,
+            .iov_len = client->output.size() - written,
+        };
+
+        struct msghdr message = {};
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+
+        alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+        bool passes_fd = false;
+
+        // a single write never spans two descriptors, so that each arrives
+        // with the reply it belongs to
+        auto output_fd = client->output_fds.begin();
+        if (output_fd != client->output_fds.end() && output_fd->first == written) {
+            passes_fd = true;
+
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+
+            struct cmsghdr* header = CMSG_FIRSTHDR(&message);
+            header->cmsg_level = SOL_SOCKET;
+            header->cmsg_type = SCM_RIGHTS;
+            header->cmsg_len = CMSG_LEN(sizeof(int));
+            std::memcpy(CMSG_DATA(header), &output_fd->second, sizeof(int));
+
+            ++output_fd;
+        }
+
+        if (output_fd != client->output_fds.end())
+            iov.iov_len = output_fd->first - written;
+
+        ssize_t length = sendmsg(client->fd, &message, MSG_NOSIGNAL);
+
+        if (length > 0) {
+            if (passes_fd)
+                client->output_fds.erase(client->output_fds.begin());
+
+            written += length;
+            continue;
+        }
+
+        if (length < 0 && errno == EINTR)
+            continue;
+
+        if (length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+
+        return false;
+    }
+
+    client->output.erase(client->output.begin(), client->output.begin() + written);
+
+    for (auto& [offset, _] : client->output_fds)
+        offset -= written;
+
+    if (client->output.size() > MAX_PENDING_OUTPUT) {
+        spdlog::warn("Dropping IPC client that stopped reading replies");
+        return false;
+    }
+
+    // only wake up on writability while a backlog remains
+    wl_event_source_fd_update(
+        client->source,
+        client->output.empty()
+            ? WL_EVENT_READABLE
+            : WL_EVENT_READABLE | WL_EVENT_WRITABLE
+    );
+
+    return true;
+}
+
+void
+IPCServer::subscribe(Client_ptr client, IPC::EventMask subscriptions)
+{
+    TRACE();
+
+    client->subscriptions = subscriptions;
+
+    if (subscriptions && client->events.empty())
+        client->events.resize(EVENT_QUEUE_CAPACITY);
+
+    m_subscriptions = 0;
+    for (Client_ptr subscriber : m_clients)
+        m_subscriptions |= subscriber->subscriptions;
+}
+
+void
+IPCServer::broadcast(QueuedEvent&& event)
+{
+    TRACE();
+
+    static constexpr std::size_t max_strings
+        = IPC::MAX_PAYLOAD - 2 * sizeof(std::int64_t);
+
+    if (event.strings.size() > max_strings)
+        event.strings.resize(max_strings);
+
+    bool queued = false;
+    for (Client_ptr client : m_clients)
+        if (client->subscriptions & IPC::event_bit(event.event)) {
+            enqueue(client, event);
+            queued = true;
+        }
+
+    // delivery waits for the end of the current dispatch, so that a burst of
+    // changes reaches each subscriber in (at most) one write
+    if (queued && !mp_deliver_source)
+        mp_deliver_source = wl_event_loop_add_idle(
+            mp_server->mp_event_loop,
+            IPCServer::handle_deliver_events,
+            this
+        );
+}
+
+void
+IPCServer::enqueue(Client_ptr client, QueuedEvent const& event)
+{
+    auto queued_at = [client](std::size_t i) -> QueuedEvent& {
+        return client->events[(client->events_head + i) % EVENT_QUEUE_CAPACITY];
+    };
+
+    // newer state supersedes queued state, but never across a view
+    // (un)registration or a reported loss, so that no event refers to a view
+    // the subscriber has not yet been told about
+    if (event.event != IPC::Event::ViewRegistered && event.event != IPC::Event::ViewUnregistered)
+        for (std::size_t i = client->events_size; i-- > 0;) {
+            QueuedEvent& queued = queued_at(i);
+
+            if (queued.event == IPC::Event::ViewRegistered
+                || queued.event == IPC::Event::ViewUnregistered
+                || queued.event == IPC::Event::Overflow)
+            {
+                break;
+            }
+
+            if (queued.event == event.event
+                && (event.event == IPC::Event::Focus
+                    || event.event == IPC::Event::Workspace
+                    || queued.key == event.key))
+            {
+                queued = event;
+                return;
+            }
+        }
+
+    if (client->events_size + 1 >= EVENT_QUEUE_CAPACITY) {
+        if (client->events_size && queued_at(client->events_size - 1).event == IPC::Event::Overflow) {
+            ++queued_at(client->events_size - 1).key;
+            return;
+        }
+
+        spdlog::warn("IPC subscriber is lagging behind, dropping events");
+        queued_at(client->events_size++) = QueuedEvent{
+            .event = IPC::Event::Overflow,
+            .key = 1,
+            .value = 0,
+            .strings = {},
+        };
+
+        return;
+    }
+
+    queued_at(client->events_size++) = event;
+}
+
+void
+IPCServer::serialize_events(Client_ptr client, std::size_t written)
+{
+    while (client->events_size
+        && client->output.size() - written < EVENT_OUTPUT_LOW_WATER)
+    {
+        QueuedEvent& event = client->events[client->events_head];
+
+        IPC::Header header = {
+            .length = static_cast<std::uint32_t>(
+                2 * sizeof(std::int64_t) + event.strings.size()
+            ),
+            .type = static_cast<std::uint16_t>(IPC::MessageType::Event),
+            .code = static_cast<std::uint16_t>(event.event),
+        };
+
+        char const* header_bytes = reinterpret_cast<char const*>(&header);
+        char const* key_bytes = reinterpret_cast<char const*>(&event.key);
+        char const* value_bytes = reinterpret_cast<char const*>(&event.value);
+
+        client->output.insert(client->output.end(), header_bytes, header_bytes + sizeof(header));
+        client->output.insert(client->output.end(), key_bytes, key_bytes + sizeof(std::int64_t));
+        client->output.insert(client->output.end(), value_bytes, value_bytes + sizeof(std::int64_t));
+        client->output.insert(client->output.end(), event.strings.begin(), event.strings.end());
+
+        event.strings.clear();
+        client->events_head = (client->events_head + 1) % EVENT_QUEUE_CAPACITY;
+        --client->events_size;
+    }
+}
+
+void
+IPCServer::handle_deliver_events(void* data)
+{
+    TRACE();
+
+    IPCServer_ptr ipc_server = reinterpret_cast<IPCServer_ptr>(data);
+    ipc_server->mp_deliver_source = nullptr;
+
+    std::vector<Client_ptr> clients = ipc_server->m_clients;
+    for (Client_ptr client : clients)
+        if (client->events_size && !ipc_server->flush(client))
+            ipc_server->disconnect(client);
+}
+
+void
+IPCServer::emit_focus(View_ptr view, Workspace_ptr workspace)
+{
+    if (!subscribed(IPC::Event::Focus))
+        return;
+
+    broadcast(QueuedEvent{
+        .event = IPC::Event::Focus,
+        .key = view ? static_cast<std::int64_t>(view->uid()) : 0,
+        .value = static_cast<std::int64_t>(workspace->index()),
+        .strings = view ? view->app_id() + '\0' + view->title() : std::string{},
+    });
+}
+
+void
+IPCServer::emit_workspace(Workspace_ptr workspace)
+{
+    if (!subscribed(IPC::Event::Workspace))
+        return;
+
+    broadcast(QueuedEvent{
+        .event = IPC::Event::Workspace,
+        .key = static_cast<std::int64_t>(workspace->index()),
+        .value = static_cast<std::int64_t>(workspace->context()->index()),
+        .strings = {},
+    });
+}
+
+void
+IPCServer::emit_layout(Workspace_ptr workspace)
+{
+    if (!subscribed(IPC::Event::Layout))
+        return;
+
+    broadcast(QueuedEvent{
+        .event = IPC::Event::Layout,
+        .key = static_cast<std::int64_t>(workspace->index()),
+        .value = static_cast<std::int64_t>(workspace->layout()),
+        .strings = {},
+    });
+}
+
+void
+IPCServer::emit_view_registered(View_ptr view)
+{
+    if (!subscribed(IPC::Event::ViewRegistered))
+        return;
+
+    broadcast(QueuedEvent{
+        .event = IPC::Event::ViewRegistered,
+        .key = static_cast<std::int64_t>(view->uid()),
+        .value = view->mp_workspace
+            ? static_cast<std::int64_t>(view->mp_workspace->index())
+            : -1,
+        .strings = view->app_id() + '\0' + view->title(),
+    });
+}
+
+void
+IPCServer::emit_view_unregistered(View_ptr view)
+{
+    if (!subscribed(IPC::Event::ViewUnregistered))
+        return;
+
+    broadcast(QueuedEvent{
+        .event = IPC::Event::ViewUnregistered,
+        .key = static_cast<std::int64_t>(view->uid()),
+        .value = 0,
+        .strings = {},
+    });
+}
+
+void
+IPCServer::emit_title(View_ptr view)
+{
+    if (!subscribed(IPC::Event::Title))
+        return;
+
+    broadcast(QueuedEvent{
+        .event = IPC::Event::Title,
+        .key = static_cast<std::int64_t>(view->uid()),
+        .value = 0,
+        .strings = view->title(),
+    });
+}
+
+void
+IPCServer::emit_app_id(View_ptr view)
+{
+    if (!subscribed(IPC::Event::AppId))
+        return;
+
+    broadcast(QueuedEvent{
+        .event = IPC::Event::AppId,
+        .key = static_cast<std::int64_t>(view->uid()),
+        .value = 0,
+        .strings = view->app_id(),
+    });
+}
+
+static bool
+in_range(std::int64_t value, std::size_t size)
+{
+    return value >= 0 && static_cast<std::uint64_t>(value) < size;
+}
+
+IPC::Status
+IPCServer::execute(
+    Client_ptr client,
+    IPC::CommandSpec const& spec,
+    std::int64_t const* integers,
+    std::string&& string,
+    std::string& message
+)
+{
+    TRACE();
+
+    View_ptr view = nullptr;
+    Toggle toggle = Toggle::Reverse;
+
+    for (std::size_t i = 0, j = 0; i < spec.arguments.size(); ++i) {
+        std::int64_t value = integers[j];
+
+        switch (spec.arguments[i]) {
+        case IPC::Argument::None:    // fallthrough
+        case IPC::Argument::String:  // fallthrough
+        case IPC::Argument::Commands: continue;
+        case IPC::Argument::Integer: break;
+        case IPC::Argument::Index:
+            if (value < 0)
+                return IPC::Status::InvalidArgument;
+            break;
+        case IPC::Argument::View:
+            view = value
+                ? mp_model->view(static_cast<Uid>(value))
+                : mp_model->focused_view();
+
+            if (!view)
+                return IPC::Status::NoSuchView;
+            break;
+        case IPC::Argument::Toggle:
+            if (!in_range(value, IPC::TOGGLE_NAMES.size()))
+                return IPC::Status::InvalidArgument;
+
+            toggle = static_cast<Toggle>(value);
+            break;
+        case IPC::Argument::Direction:
+            if (!in_range(value, IPC::DIRECTION_NAMES.size()))
+                return IPC::Status::InvalidArgument;
+            break;
+        case IPC::Argument::Layout:
+            if (!in_range(value, IPC::LAYOUT_NAMES.size()))
+                return IPC::Status::InvalidArgument;
+            break;
+        case IPC::Argument::Criterium:
+            if (!in_range(value, IPC::CRITERIUM_NAMES.size()))
+                return IPC::Status::InvalidArgument;
+            break;
+        case IPC::Argument::SyncPolicy:
+            if (!in_range(value, IPC::SYNC_POLICY_NAMES.size()))
+                return IPC::Status::InvalidArgument;
+            break;
+        case IPC::Argument::Events:
+            if (!in_range(value, std::size_t{1} << IPC::EVENT_NAMES.size()))
+                return IPC::Status::InvalidArgument;
+            break;
+        }
+
+        ++j;
+    }
+
+    switch (spec.command) {
+    case IPC::Command::Ping: break;
+    case IPC::Command::Exit: mp_model->exit(); break;
+    case IPC::Command::FocusedView:
+    {
+        View_ptr focus = mp_model->focused_view();
+        if (!focus)
+            return IPC::Status::NoSuchView;
+
+        message = std::to_string(focus->uid())
+            + '\t' + focus->app_id()
+            + '\t' + focus->title();
+        break;
+    }
+    case IPC::Command::FocusView: mp_model->focus_view(view); break;
+    case IPC::Command::KillView:  mp_model->kill_view(view);  break;
+    case IPC::Command::JumpView:
+    {
+        // the wire criteria skip OnWorkspaceBySelector
+        SearchSelector::SelectionCriterium criterium
+            = static_cast<SearchSelector::SelectionCriterium>(integers[0] + 1);
+
+        mp_model->jump_view(SearchSelector{criterium, std::move(string)});
+        break;
+    }
+    case IPC::Command::CycleFocus:
+    {
+        mp_model->cycle_focus(static_cast<Direction>(integers[0]));
+        break;
+    }
+    case IPC::Command::ActivateWorkspace:
+    {
+        if (!mp_model->workspace(integers[0]))
+            return IPC::Status::InvalidArgument;
+
+        mp_model->activate_workspace(integers[0]);
+        break;
+    }
+    case IPC::Command::ActivateContext:
+    {
+        if (!mp_model->context(integers[0]))
+            return IPC::Status::InvalidArgument;
+
+        mp_model->activate_context(integers[0]);
+        break;
+    }
+    case IPC::Command::ActivateOutput:
+    {
+        if (!mp_model->output(integers[0]))
+            return IPC::Status::InvalidArgument;
+
+        mp_model->activate_output(integers[0]);
+        break;
+    }
+    case IPC::Command::ToggleWorkspace: mp_model->toggle_workspace(); break;
+    case IPC::Command::ToggleContext:   mp_model->toggle_context();   break;
+    case IPC::Command::ToggleOutput:    mp_model->toggle_output();    break;
+    case IPC::Command::MoveViewToWorkspace:
+    {
+        Workspace_ptr workspace = mp_model->workspace(integers[1]);
+        if (!workspace)
+            return IPC::Status::InvalidArgument;
+
+        mp_model->move_view_to_workspace(view, workspace);
+        break;
+    }
+    case IPC::Command::MoveViewToContext:
+    {
+        Context_ptr context = mp_model->context(integers[1]);
+        if (!context)
+            return IPC::Status::InvalidArgument;
+
+        mp_model->move_view_to_context(view, context);
+        break;
+    }
+    case IPC::Command::MoveViewToOutput:
+    {
+        Output_ptr output = mp_model->output(integers[1]);
+        if (!output)
+            return IPC::Status::InvalidArgument;
+
+        mp_model->move_view_to_output(view, output);
+        break;
+    }
+    case IPC::Command::SetLayout:
+    {
+        mp_model->set_layout(static_cast<LayoutHandler::LayoutKind>(integers[0]));
+        break;
+    }
+    case IPC::Command::ToggleLayout:      mp_model->toggle_layout();                   break;
+    case IPC::Command::SetFloatingView:   mp_model->set_floating_view(toggle, view);   break;
+    case IPC::Command::SetFullscreenView: mp_model->set_fullscreen_view(toggle, view); break;
+    case IPC::Command::SetStickyView:     mp_model->set_sticky_view(toggle, view);     break;
+    case IPC::Command::SetIconifyView:    mp_model->set_iconify_view(toggle, view);    break;
+    case IPC::Command::CenterView:        mp_model->center_view(view);                 break;
+    case IPC::Command::PopDeiconify:      mp_model->pop_deiconify();                   break;
+    case IPC::Command::DeiconifyAll:      mp_model->deiconify_all();                   break;
+    case IPC::Command::Spawn:
+    {
+        if (string.empty())
+            return IPC::Status::InvalidArgument;
+
+        mp_model->spawn_external(std::move(string));
+        break;
+    }
+    case IPC::Command::SetMaxRenderTime:
+    {
+        // a negative budget selects the adaptive scheduler
+        mp_model->set_max_render_time(integers[0] < 0
+            ? std::nullopt
+            : std::optional<int>(std::min<std::int64_t>(integers[0], 1000)));
+        break;
+    }
+    case IPC::Command::SetPowerSaver: mp_model->set_power_saver(toggle); break;
+    case IPC::Command::SetAdaptiveSyncPolicy:
+    {
+        mp_model->set_adaptive_sync_policy(
+            static_cast<Output::AdaptiveSyncPolicy>(integers[0])
+        );
+        break;
+    }
+    case IPC::Command::ReportOutputStats: mp_model->report_output_stats(); break;
+    case IPC::Command::ResetOutputStats:  mp_model->reset_output_stats();  break;
+    case IPC::Command::Subscribe:
+    {
+        subscribe(client, static_cast<IPC::EventMask>(integers[0]));
+        break;
+    }
+    default: return IPC::Status::UnknownCommand;
+    }
+
+    return IPC::Status::Ok;
+}
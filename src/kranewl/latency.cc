@@ -0,0 +1,197 @@
+#include <trace.hh>
+
+#include <kranewl/latency.hh>
+
+#include <spdlog/fmt/fmt.h>
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+LatencyHistogram::~LatencyHistogram()
+{}
+
+void
+LatencyHistogram::record(std::uint64_t latency)
+{
+    std::uint64_t bucket = latency / BUCKET_WIDTH_NS;
+
+    if (bucket < BUCKET_COUNT)
+        ++m_buckets[bucket];
+    else
+        ++m_overflow;
+
+    m_min = std::min(m_min, latency);
+    m_max = std::max(m_max, latency);
+    m_sum += latency;
+    ++m_count;
+}
+
+void
+LatencyHistogram::reset()
+{
+    m_buckets.fill(0);
+    m_overflow = 0;
+    m_count = 0;
+    m_sum = 0;
+    m_min = UINT64_MAX;
+    m_max = 0;
+}
+
+std::uint64_t
+LatencyHistogram::percentile(double fraction) const
+{
+    if (!m_count)
+        return 0;
+
+    std::uint64_t rank = static_cast<std::uint64_t>(
+        std::ceil(std::clamp(fraction, 0.0, 1.0) * m_count)
+    );
+
+    if (!rank)
+        rank = 1;
+
+    // report the upper edge of the bucket the rank falls in, clamped to the
+    // exact extrema so that sparse histograms do not overstate the latency
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += m_buckets[i];
+
+        if (seen >= rank)
+            return std::clamp((i + 1) * BUCKET_WIDTH_NS, min(), m_max);
+    }
+
+    return m_max;
+}
+
+std::string
+LatencyHistogram::summary() const
+{
+    static constexpr double NS_PER_MS = 1e6;
+
+    return fmt::format(
+        "n={} min={:.2f}ms mean={:.2f}ms p50={:.2f}ms p90={:.2f}ms"
+        " p99={:.2f}ms max={:.2f}ms overflow={}",
+        m_count,
+        min() / NS_PER_MS,
+        mean() / NS_PER_MS,
+        percentile(.5) / NS_PER_MS,
+        percentile(.9) / NS_PER_MS,
+        percentile(.99) / NS_PER_MS,
+        m_max / NS_PER_MS,
+        m_overflow
+    );
+}
+
+LatencyTracker::LatencyTracker()
+    : m_input_time({}),
+      m_in_flight({}),
+      m_histogram({})
+{}
+
+LatencyTracker::~LatencyTracker()
+{}
+
+std::uint64_t
+LatencyTracker::now()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return static_cast<std::uint64_t>(now.tv_sec) * 1'000'000'000
+        + static_cast<std::uint64_t>(now.tv_nsec);
+}
+
+std::optional<std::uint64_t>
+LatencyTracker::input_time(std::uint32_t time_msec)
+{
+    // input timestamps are truncated monotonic milliseconds, so their age is
+    // computed in wrapping 32-bit arithmetic and subtracted from the full clock
+    std::uint64_t now_ns = now();
+    std::uint32_t age = static_cast<std::uint32_t>(now_ns / 1'000'000) - time_msec;
+    std::uint64_t age_ns = static_cast<std::uint64_t>(age) * 1'000'000;
+
+    // backends that do not stamp events with the monotonic clock (e.g., when
+    // nested) produce nonsensical ages, which would only pollute the histograms
+    if (age_ns > MAX_INPUT_AGE_NS || age_ns > now_ns)
+        return std::nullopt;
+
+    return now_ns - age_ns;
+}
+
+void
+LatencyTracker::mark_input(std::uint64_t input_time)
+{
+    if (!m_input_time || input_time < *m_input_time)
+        m_input_time = input_time;
+}
+
+void
+LatencyTracker::commit(std::uint32_t commit_seq)
+{
+    if (!m_input_time)
+        return;
+
+    // input that waited this long on an idle output says nothing about latency
+    if (now() - *m_input_time > MAX_INPUT_AGE_NS) {
+        m_input_time = std::nullopt;
+        return;
+    }
+
+    if (m_in_flight.size() >= MAX_IN_FLIGHT)
+        m_in_flight.pop_front();
+
+    m_in_flight.push_back(InFlight{
+        .commit_seq = commit_seq,
+        .input_time = *m_input_time,
+    });
+
+    m_input_time = std::nullopt;
+}
+
+void
+LatencyTracker::present(std::uint32_t commit_seq, bool presented, std::uint64_t when)
+{
+    std::optional<std::uint64_t> input_time = std::nullopt;
+
+    // earlier commits that were never reported are superseded by this one
+    while (!m_in_flight.empty()) {
+        InFlight const& in_flight = m_in_flight.front();
+        std::int32_t distance
+            = static_cast<std::int32_t>(commit_seq - in_flight.commit_seq);
+
+        if (distance < 0)
+            break;
+
+        if (!input_time || in_flight.input_time < *input_time)
+            input_time = in_flight.input_time;
+
+        m_in_flight.pop_front();
+    }
+
+    if (!input_time)
+        return;
+
+    // a discarded frame never reached the screen, the input it carried is
+    // instead reflected by whichever frame is committed next
+    if (!presented) {
+        mark_input(*input_time);
+        return;
+    }
+
+    if (when >= *input_time)
+        m_histogram.record(when - *input_time);
+}
+
+void
+LatencyTracker::reset()
+{
+    m_input_time = std::nullopt;
+    m_in_flight.clear();
+    m_histogram.reset();
+}
@@ -11,6 +11,9 @@
 #include <kranewl/input/cursor-bindings.hh>
 #include <kranewl/input/cursor.hh>
 #include <kranewl/input/key-bindings.hh>
+#include <kranewl/ipc-server.hh>
+#include <kranewl/latency.hh>
+#include <kranewl/rules-watcher.hh>
 #include <kranewl/server.hh>
 #include <kranewl/tree/output.hh>
 #include <kranewl/tree/view.hh>
@@ -21,9 +24,9 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <cstring>
 #include <iomanip>
 #include <optional>
-#include <set>
 
 // https://github.com/swaywm/wlroots/issues/682
 #include <pthread.h>
@@ -31,6 +34,7 @@
 #define namespace namespace_
 #define static
 extern "C" {
+#include <wlr/types/wlr_scene.h>
 #include <wlr/types/wlr_surface.h>
 }
 #undef static
@@ -54,11 +58,24 @@ Model::Model(Config const& config)
       m_unmanaged_map{},
       m_pid_map{},
       m_fullscreen_map{},
-      m_sticky_views{},
+      m_search_index{},
+      m_spatial_index{},
       mp_focus(nullptr),
       mp_jumped_from(nullptr),
       mp_next_view(nullptr),
       mp_prev_view(nullptr),
+      m_rules_path(std::nullopt),
+      mp_rules_watcher(nullptr),
+      m_layout_counters{},
+      m_occluders{},
+      m_occluded_views{},
+      m_power_saver(false),
+      mp_transaction(nullptr),
+      m_batch_depth(0),
+      m_focus_sync_deferred(false),
+      m_dirty_workspaces{},
+      mp_arrange_source(nullptr),
+      m_snapshot_writer{},
       m_key_bindings(Bindings::key_bindings),
       m_cursor_bindings(Bindings::cursor_bindings)
 {
@@ -95,6 +112,8 @@ Model::Model(Config const& config)
 
     mp_context = *m_contexts.active_element();
     mp_workspace = *m_workspaces.active_element();
+
+    publish_snapshot();
 }
 
 Model::~Model()
@@ -117,11 +136,37 @@ Model::retrieve_user_default_rules(std::optional<std::string> const& rules_path)
     TRACE();
 
     if (rules_path) {
-        spdlog::info("Compiling default rules from {}", *rules_path);
-        m_default_rules = Rules::compile_default_rules(*rules_path);
+        if (file_exists(*rules_path)) {
+            spdlog::info("Compiling default rules from {}", *rules_path);
+            Rules::compile_default_rules(*rules_path, m_default_rules);
+            spdlog::info("Compiled {} default rules", m_default_rules.size());
+        } else
+            spdlog::info("No default rules at {}", *rules_path);
+
+        m_rules_path = rules_path;
+        if (mp_server && !mp_rules_watcher)
+            mp_rules_watcher = new RulesWatcher(mp_server, this, *rules_path);
     }
 }
 
+void
+Model::reload_user_default_rules()
+{
+    TRACE();
+
+    if (!m_rules_path)
+        return;
+
+    RuleMatcher default_rules{};
+    if (!Rules::compile_default_rules(*m_rules_path, default_rules)) {
+        spdlog::warn("Could not read {}, keeping current default rules", *m_rules_path);
+        return;
+    }
+
+    m_default_rules = std::move(default_rules);
+    spdlog::info("Reloaded {} default rules from {}", m_default_rules.size(), *m_rules_path);
+}
+
 void
 Model::run_user_autostart(
     [[maybe_unused]] std::optional<std::string> const& autostart_path
@@ -140,7 +185,9 @@ void
 Model::register_server(Server_ptr server)
 {
     TRACE();
+
     mp_server = server;
+    mp_transaction = new Transaction(server, this);
 }
 
 void
@@ -158,6 +205,16 @@ Model::focused_view() const
     return mp_focus;
 }
 
+View_ptr
+Model::view(Uid uid) const
+{
+    auto view = m_view_map.find(uid);
+    if (view != m_view_map.end())
+        return view->second;
+
+    return nullptr;
+}
+
 Workspace_ptr
 Model::workspace(Index index) const
 {
@@ -254,8 +311,10 @@ Model::unregister_output(Output_ptr output)
     TRACE();
 
     Context_ptr context = output->context();
-    if (context)
+    if (context) {
+        context->workspace()->set_scene_enabled(false);
         context->set_output(nullptr);
+    }
 
     m_outputs.remove_element(output);
     delete output;
@@ -276,6 +335,7 @@ Model::output_reserve_context(Output_ptr output)
     if (context) {
         output->set_context(*context);
         (*context)->set_output(output);
+        (*context)->workspace()->set_scene_enabled(true);
 
         spdlog::info("Assigned context {} to output {}",
             (*context)->index(),
@@ -301,6 +361,159 @@ Model::update_outputs()
     }
 }
 
+void
+Model::register_input(uint32_t time_msec)
+{
+    // key presses are reflected on the output that holds keyboard focus
+    register_input(
+        time_msec,
+        mp_focus && mp_focus->mp_context && mp_focus->mp_context->output()
+            ? mp_focus->mp_context->output()
+            : mp_output
+    );
+}
+
+void
+Model::register_input(uint32_t time_msec, Output_ptr output)
+{
+    if (!output)
+        return;
+
+    std::optional<uint64_t> input_time = LatencyTracker::input_time(time_msec);
+    if (!input_time)
+        return;
+
+    // marking only this output keeps idle outputs from holding on to input
+    // that they would otherwise attribute to a frame committed much later
+    output->m_latency.mark_input(*input_time);
+}
+
+void
+Model::report_output_stats()
+{
+    TRACE();
+
+    for (Output_ptr output : m_outputs) {
+        spdlog::info("Input-to-present latency on {}: {}",
+            output->mp_wlr_output->name,
+            output->m_latency.histogram().summary()
+        );
+
+        spdlog::info("Frames on {}: committed={} skipped={} deferred={} failed={}",
+            output->mp_wlr_output->name,
+            output->m_frame_stats.committed,
+            output->m_frame_stats.skipped,
+            output->m_frame_stats.deferred,
+            output->m_frame_stats.failed
+        );
+
+        spdlog::info("Scanout on {}: view={} scanned_out={} composited={} blocker={}",
+            output->mp_wlr_output->name,
+            output->scanout_view()
+                ? output->scanout_view()->uid_formatted()
+                : std::string{"none"},
+            output->m_scanout_stats.scanned_out,
+            output->m_scanout_stats.composited,
+            output->last_scanout_blocker()
+                ? output->last_scanout_blocker()
+                : "none"
+        );
+
+        spdlog::info("Adaptive sync on {}: {}",
+            output->mp_wlr_output->name,
+            output->mp_wlr_output->adaptive_sync_status == WLR_OUTPUT_ADAPTIVE_SYNC_ENABLED
+                ? "enabled"
+                : "disabled"
+        );
+    }
+
+    spdlog::info("Layouts: arranged={} coalesced={} placements={}",
+        m_layout_counters.arranges,
+        m_layout_counters.arranges_coalesced,
+        m_layout_counters.placements
+    );
+}
+
+void
+Model::reset_output_stats()
+{
+    TRACE();
+
+    for (Output_ptr output : m_outputs) {
+        output->m_latency.reset();
+        output->m_frame_stats = {};
+        output->m_scanout_stats = {};
+    }
+}
+
+void
+Model::set_max_render_time(std::optional<int> max_render_time)
+{
+    TRACE();
+
+    if (!mp_output)
+        return;
+
+    // no value selects the adaptive budget, zero disables delayed rendering
+    if (!max_render_time)
+        mp_output->m_frame_scheduler.set_mode(FrameScheduler::Mode::Adaptive);
+    else if (*max_render_time <= 0)
+        mp_output->m_frame_scheduler.set_mode(FrameScheduler::Mode::Immediate);
+    else
+        mp_output->m_frame_scheduler.set_mode(
+            FrameScheduler::Mode::Fixed,
+            std::chrono::milliseconds(*max_render_time)
+        );
+}
+
+void
+Model::set_adaptive_sync_policy(Output::AdaptiveSyncPolicy policy)
+{
+    TRACE();
+
+    if (mp_output)
+        mp_output->set_adaptive_sync_policy(policy);
+}
+
+void
+Model::set_power_saver(Toggle toggle)
+{
+    TRACE();
+
+    switch (toggle) {
+    case Toggle::On:      m_power_saver = true;          break;
+    case Toggle::Off:     m_power_saver = false;         break;
+    case Toggle::Reverse: m_power_saver = !m_power_saver; break;
+    default: return;
+    }
+
+    spdlog::info("Power saver mode {}", m_power_saver ? "enabled" : "disabled");
+}
+
+unsigned
+Model::frame_rate_cap(View_ptr view) const
+{
+    if (view->focused())
+        return 0;
+
+    FrameRateCaps const& caps = m_power_saver
+        ? POWER_SAVER_FRAME_RATE_CAPS
+        : DEFAULT_FRAME_RATE_CAPS;
+
+    // a rule's frame rate replaces the unfocused cap, background views are
+    // further held to the (lower) background cap, if any
+    unsigned frame_rate = view->frame_rate().value_or(caps.unfocused);
+
+    if (caps.background && (!frame_rate || caps.background < frame_rate)
+        && (view->scene_layer() == SCENE_LAYER_BOTTOM
+            || view->iconified() || view->disowned()))
+    {
+        frame_rate = caps.background;
+    }
+
+    return frame_rate;
+}
+
 void
 Model::focus_view(View_ptr view)
 {
@@ -314,19 +527,24 @@ Model::focus_view(View_ptr view)
     if (!output || mp_focus == view)
         return;
 
-    if (!view->sticky() || view->mp_context != mp_context) {
-        activate_workspace(view->mp_workspace);
-        mp_workspace->activate_view(view);
-    }
+    activate_workspace(view->mp_workspace);
+    mp_workspace->activate_view(view);
 
     if (mp_focus)
         mp_focus->focus(Toggle::Off);
 
     view->focus(Toggle::On);
     mp_focus = view;
+    m_search_index.touch(view);
+
+    if (mp_server->mp_ipc_server)
+        mp_server->mp_ipc_server->emit_focus(view, view->mp_workspace);
 
     if (mp_workspace->layout_is_persistent() || mp_workspace->layout_is_single())
         apply_layout(mp_workspace);
+    else
+        // focusing raises the view, which may uncover or hide others
+        update_occlusion(view->mp_workspace);
 
     view->mp_workspace->activate_track(view->scene_layer());
 }
@@ -340,13 +558,12 @@ Model::refocus()
     if (!mp_focus || !(output = mp_focus->mp_context->output()))
         return;
 
-    if (!mp_focus->sticky() || mp_focus->mp_context != mp_context) {
-        activate_workspace(mp_focus->mp_workspace);
-        mp_workspace->activate_view(mp_focus);
-    }
+    activate_workspace(mp_focus->mp_workspace);
+    mp_workspace->activate_view(mp_focus);
 
     mp_focus->focus(Toggle::Off);
     mp_focus->focus(Toggle::On);
+    m_search_index.touch(mp_focus);
 
     if (mp_workspace->layout_is_persistent() || mp_workspace->layout_is_single())
         apply_layout(mp_workspace);
@@ -367,45 +584,20 @@ Model::place_view(Placement& placement)
     TRACE();
 
     View_ptr view = placement.view;
+    SceneLayer layer = SceneLayer::SCENE_LAYER_TILE;
 
-    if (!placement.region) {
-        switch (placement.method) {
-        case Placement::PlacementMethod::Free:
-        {
-            view->set_free(true);
-            view->set_free_decoration(placement.decoration);
-            move_view_to_track(view, SceneLayer::SCENE_LAYER_FREE);
-            break;
-        }
-        case Placement::PlacementMethod::Tile:
-        {
-            view->set_free(false);
-            view->set_free_decoration(FREE_DECORATION);
-            view->set_tile_decoration(placement.decoration);
-            move_view_to_track(view, SceneLayer::SCENE_LAYER_TILE);
-            break;
-        }
-        case Placement::PlacementMethod::Fullscreen:
-        {
-            view->set_free(false);
-            view->set_free_decoration(FREE_DECORATION);
-            view->set_tile_decoration(placement.decoration);
-            move_view_to_track(view, SceneLayer::SCENE_LAYER_OVERLAY);
-            break;
-        }
-        }
-
-        view->unmap();
-        return;
-    }
+    ++m_layout_counters.placements;
 
     switch (placement.method) {
     case Placement::PlacementMethod::Free:
     {
         view->set_free(true);
         view->set_free_decoration(placement.decoration);
-        view->set_free_region(*placement.region);
-        move_view_to_track(view, SceneLayer::SCENE_LAYER_FREE);
+
+        if (placement.region)
+            view->set_free_region(*placement.region);
+
+        layer = SceneLayer::SCENE_LAYER_FREE;
         break;
     }
     case Placement::PlacementMethod::Tile:
@@ -413,31 +605,78 @@ Model::place_view(Placement& placement)
         view->set_free(false);
         view->set_free_decoration(FREE_DECORATION);
         view->set_tile_decoration(placement.decoration);
-        view->set_tile_region(*placement.region);
-        move_view_to_track(view, SceneLayer::SCENE_LAYER_TILE);
+
+        if (placement.region)
+            view->set_tile_region(*placement.region);
+
+        layer = SceneLayer::SCENE_LAYER_TILE;
         break;
     }
     case Placement::PlacementMethod::Fullscreen:
     {
+        if (!placement.region) {
+            view->set_free(false);
+            view->set_free_decoration(FREE_DECORATION);
+        }
+
         view->set_tile_decoration(placement.decoration);
-        view->set_tile_region(*placement.region);
-        move_view_to_track(view, SceneLayer::SCENE_LAYER_OVERLAY);
+
+        // fullscreen views cover the entire output, exclusive zones included
+        if (placement.region && view->fullscreen() && !view->contained()
+            && view->mp_context && view->mp_context->output())
+        {
+            placement.region = view->mp_context->output()->full_region();
+        }
+
+        if (placement.region)
+            view->set_tile_region(*placement.region);
+
+        layer = SceneLayer::SCENE_LAYER_OVERLAY;
         break;
     }
     }
 
+    if (view->scene_layer() != layer)
+        move_view_to_track(view, layer);
+    else
+        ++m_layout_counters.relayers_skipped;
+
+    if (!placement.region) {
+        view->unmap();
+        return;
+    }
+
+    if (view->mapped())
+        ++m_layout_counters.maps_skipped;
+    else
+        view->map();
+
+    if (view->configured_as(
+        view->active_region(),
+        view->active_decoration().extents()
+    )) {
+        ++m_layout_counters.configures_skipped;
+        return;
+    }
+
     spdlog::info(
         "Placing view {} at {}",
         view->uid_formatted(),
         std::to_string(view->active_region())
     );
 
-    view->map();
-    view->configure(
-        view->active_region(),
-        view->active_decoration().extents(),
-        false
-    );
+    if (mp_transaction)
+        mp_transaction->add(
+            view,
+            view->active_region(),
+            view->active_decoration().extents()
+        );
+    else
+        view->configure(
+            view->active_region(),
+            view->active_decoration().extents(),
+            false
+        );
 }
 
 bool
@@ -463,10 +702,14 @@ Model::view_matches_search(View_ptr view, SearchSelector const& selector) const
         return view->title() == selector.string_value();
     case SearchSelector::SelectionCriterium::ByAppIdEquals:
         return view->app_id() == selector.string_value();
+    case SearchSelector::SelectionCriterium::ByHandleEquals:
+        return view->handle() == selector.string_value();
     case SearchSelector::SelectionCriterium::ByTitleContains:
         return view->title().find(selector.string_value()) != std::string::npos;
     case SearchSelector::SelectionCriterium::ByAppIdContains:
         return view->app_id().find(selector.string_value()) != std::string::npos;
+    case SearchSelector::SelectionCriterium::ByHandleContains:
+        return view->handle().find(selector.string_value()) != std::string::npos;
     case SearchSelector::SelectionCriterium::ForCondition:
         return selector.filter()(view);
     default: break;
@@ -480,16 +723,6 @@ Model::search_view(SearchSelector const& selector)
 {
     TRACE();
 
-    static constexpr struct LastFocusedComparer final {
-        bool
-        operator()(const View_ptr lhs, const View_ptr rhs) const
-        {
-            return lhs->last_focused() < rhs->last_focused();
-        }
-    } last_focused_comparer{};
-
-    std::set<View_ptr, LastFocusedComparer> views{{}, last_focused_comparer};
-
     switch (selector.criterium()) {
     case SearchSelector::SelectionCriterium::OnWorkspaceBySelector:
     {
@@ -500,24 +733,29 @@ Model::search_view(SearchSelector const& selector)
             std::optional<View_ptr> view = workspace->find_view(selector_);
 
             if (view && (*view)->managed())
-                views.insert(*view);
+                return *view;
         }
 
-        break;
-    }
-    default:
-    {
-        for (auto const&[_,view] : m_view_map)
-            if (view->managed() && view_matches_search(view, selector))
-                views.insert(view);
-
-        break;
+        return nullptr;
     }
+    case SearchSelector::SelectionCriterium::ByTitleEquals:
+        return m_search_index.find_equal(SearchIndex::Key::Title, selector.string_value());
+    case SearchSelector::SelectionCriterium::ByAppIdEquals:
+        return m_search_index.find_equal(SearchIndex::Key::AppId, selector.string_value());
+    case SearchSelector::SelectionCriterium::ByHandleEquals:
+        return m_search_index.find_equal(SearchIndex::Key::Handle, selector.string_value());
+    case SearchSelector::SelectionCriterium::ByTitleContains:
+        return m_search_index.find_containing(SearchIndex::Key::Title, selector.string_value());
+    case SearchSelector::SelectionCriterium::ByAppIdContains:
+        return m_search_index.find_containing(SearchIndex::Key::AppId, selector.string_value());
+    case SearchSelector::SelectionCriterium::ByHandleContains:
+        return m_search_index.find_containing(SearchIndex::Key::Handle, selector.string_value());
+    case SearchSelector::SelectionCriterium::ForCondition:
+        return m_search_index.find_most_recent(selector.filter());
+    default: break;
     }
 
-    return views.empty()
-        ? nullptr
-        : *views.rbegin();
+    return nullptr;
 }
 
 void
@@ -540,6 +778,13 @@ Model::jump_view(SearchSelector const& selector)
     }
 }
 
+void
+Model::reindex_view(View_ptr view)
+{
+    TRACE();
+    m_search_index.update(view);
+}
+
 void
 Model::cursor_interactive(Cursor::Mode mode, View_ptr view)
 {
@@ -561,10 +806,17 @@ Model::sync_focus()
 {
     TRACE();
 
+    if (m_batch_depth) {
+        m_focus_sync_deferred = true;
+        return;
+    }
+
     View_ptr active = mp_workspace->active();
 
-    if (active == mp_focus)
+    if (active == mp_focus) {
+        publish_snapshot();
         return;
+    }
 
     if (mp_focus)
         mp_focus->focus(Toggle::Off);
@@ -575,9 +827,13 @@ Model::sync_focus()
     } else if (mp_workspace->empty()) {
         mp_server->relinquish_focus();
         mp_focus = nullptr;
+
+        if (mp_server->mp_ipc_server)
+            mp_server->mp_ipc_server->emit_focus(nullptr, mp_workspace);
     }
 
     sync_indicators();
+    publish_snapshot();
 }
 
 void
@@ -603,6 +859,53 @@ Model::sync_indicators()
     }
 }
 
+template <std::size_t N>
+static void
+copy_snapshot_string(char (&destination)[N], std::string const& source)
+{
+    std::size_t size = std::min(source.size(), N - 1);
+    std::memcpy(destination, source.data(), size);
+    destination[size] = '\0';
+}
+
+void
+Model::publish_snapshot()
+{
+    TRACE();
+
+    if (!m_snapshot_writer.available())
+        return;
+
+    std::optional<Index> output_index = mp_output
+        ? m_outputs.index_of_element(mp_output)
+        : std::nullopt;
+
+    IPC::Snapshot::State& state = m_snapshot_writer.begin();
+
+    state.output = output_index ? *output_index : IPC::SNAPSHOT_NONE;
+    state.context = mp_context->index();
+    state.workspace = mp_workspace->index();
+    state.workspace_count = std::min(m_workspaces.size(), IPC::SNAPSHOT_MAX_WORKSPACES);
+
+    for (std::size_t i = 0; i < state.workspace_count; ++i)
+        state.workspaces[i] = IPC::Snapshot::Workspace{
+            .view_count = static_cast<std::uint32_t>(m_workspaces[i]->size()),
+            .layout = static_cast<std::uint32_t>(m_workspaces[i]->layout()),
+        };
+
+    state.focus = mp_focus ? mp_focus->uid() : 0;
+    copy_snapshot_string(state.focus_app_id, mp_focus ? mp_focus->app_id() : std::string{});
+    copy_snapshot_string(state.focus_title, mp_focus ? mp_focus->title() : std::string{});
+
+    m_snapshot_writer.end();
+}
+
+int
+Model::snapshot_fd() const
+{
+    return m_snapshot_writer.available() ? m_snapshot_writer.fd() : -1;
+}
+
 void
 Model::relayer_views(Workspace_ptr workspace)
 {
@@ -861,17 +1164,25 @@ Model::move_view_to_workspace(View_ptr view, Workspace_ptr workspace_to)
     Context_ptr context_to = workspace_to->context();
     Output_ptr output_to = context_to->output();
 
+    if (view->sticky() && view->mp_context) {
+        view->mp_context->unregister_sticky_view(view);
+
+        // sticky views only ever live in their context's active workspace
+        if (workspace_to == context_to->workspace())
+            context_to->register_sticky_view(view);
+        else {
+            view->set_sticky(false);
+            view->render_decoration();
+        }
+    }
+
     view->mp_context = context_to;
     view->mp_output = output_to;
 
     workspace_to->add_view(view);
+    view->reparent();
     apply_layout(workspace_to);
 
-    if (output_to && output_to->workspace() == workspace_to)
-        view->map();
-    else
-        view->unmap();
-
     sync_focus();
 }
 
@@ -927,6 +1238,11 @@ Model::move_view_to_context(View_ptr view, Context_ptr context_to)
         apply_layout(workspace_from);
     }
 
+    if (view->sticky()) {
+        view->mp_context->unregister_sticky_view(view);
+        context_to->register_sticky_view(view);
+    }
+
     view->mp_context = context_to;
 
     Workspace_ptr workspace_to = context_to->workspace();
@@ -936,13 +1252,9 @@ Model::move_view_to_context(View_ptr view, Context_ptr context_to)
     view->mp_output = output_to;
 
     workspace_to->add_view(view);
+    view->reparent();
     apply_layout(workspace_to);
 
-    if (output_to && output_to != output_from)
-        view->map();
-    else
-        view->unmap();
-
     sync_focus();
 }
 
@@ -999,6 +1311,9 @@ Model::move_view_to_output(View_ptr view, Output_ptr output_to)
         wlr_surface_send_leave(view->mp_wlr_surface, output_from->mp_wlr_output);
     }
 
+    if (view->sticky() && view->mp_context)
+        view->mp_context->unregister_sticky_view(view);
+
     if (!output_to || !output_to->context()) {
         view->mp_output = nullptr;
         view->mp_context = nullptr;
@@ -1013,14 +1328,15 @@ Model::move_view_to_output(View_ptr view, Output_ptr output_to)
     view->mp_context = context_to;
     view->mp_workspace = workspace_to;
 
+    if (view->sticky())
+        context_to->register_sticky_view(view);
+
     workspace_to->add_view(view);
+    view->reparent();
     apply_layout(workspace_to);
 
-    if (output_to && output_to != output_from) {
+    if (output_to != output_from)
         wlr_surface_send_enter(view->mp_wlr_surface, output_to->mp_wlr_output);
-        view->map();
-    } else
-        view->unmap();
 
     sync_focus();
 }
@@ -1128,19 +1444,27 @@ Model::activate_workspace(Workspace_ptr next_workspace)
             );
     }
 
-    if (next_context == prev_context) {
-        for (View_ptr view : *prev_workspace)
-            if (!view->sticky())
-                view->unmap();
+    Workspace_ptr replaced_workspace = next_context->workspace();
 
-        for (View_ptr view : m_sticky_views)
+    // sticky views follow their context's active workspace, so that its
+    // focus cycle reaches them; their scene nodes stay in the context overlay
+    if (replaced_workspace != next_workspace)
+        for (View_ptr view : next_context->sticky_views()) {
+            replaced_workspace->remove_view(view);
+            next_workspace->adopt_view(view);
             view->mp_workspace = next_workspace;
-    }
+        }
+
+    replaced_workspace->set_scene_enabled(false);
+    next_workspace->set_scene_enabled(next_context->output() != nullptr);
 
     next_context->activate_workspace(next_workspace);
     m_workspaces.activate_element(next_workspace);
     mp_workspace = next_workspace;
 
+    if (mp_server->mp_ipc_server)
+        mp_server->mp_ipc_server->emit_workspace(next_workspace);
+
     apply_layout(next_workspace);
     sync_focus();
 
@@ -1151,8 +1475,11 @@ Model::activate_workspace(Workspace_ptr next_workspace)
         if (last_cursor_pos) {
             mp_server->mp_seat->mp_cursor->set_cursor_pos(*last_cursor_pos);
             mp_focus->set_last_cursor_pos(std::nullopt);
-        } else
+        } else {
+            // the view under the cursor is only known once arranged
+            arrange_dirty_workspaces();
             mp_output->focus_at_cursor();
+        }
     }
 }
 
@@ -1191,15 +1518,14 @@ Model::activate_context(Context_ptr next_context)
 
     abort_cursor_interactive();
 
-    for (View_ptr view : *mp_workspace)
-        view->unmap();
-
     Context_ptr prev_context = mp_context;
     mp_prev_context = prev_context;
 
     Output_ptr next_output = mp_output;
     Output_ptr prev_output = next_context->output();
 
+    mp_workspace->set_scene_enabled(false);
+
     if (prev_output && next_output != prev_output)
         prev_output->set_context(prev_context);
 
@@ -1260,6 +1586,11 @@ Model::toggle_layout()
     mp_workspace->toggle_layout();
     apply_layout(mp_workspace);
     relayer_views(mp_workspace);
+
+    publish_snapshot();
+
+    if (mp_server->mp_ipc_server)
+        mp_server->mp_ipc_server->emit_layout(mp_workspace);
 }
 
 void
@@ -1270,6 +1601,11 @@ Model::set_layout(LayoutHandler::LayoutKind layout)
     mp_workspace->set_layout(layout);
     apply_layout(mp_workspace);
     relayer_views(mp_workspace);
+
+    publish_snapshot();
+
+    if (mp_server->mp_ipc_server)
+        mp_server->mp_ipc_server->emit_layout(mp_workspace);
 }
 
 void
@@ -1306,6 +1642,11 @@ Model::set_layout_retain_region(LayoutHandler::LayoutKind layout)
 
     relayer_views(mp_workspace);
     apply_layout(mp_workspace);
+
+    publish_snapshot();
+
+    if (mp_server->mp_ipc_server)
+        mp_server->mp_ipc_server->emit_layout(mp_workspace);
 }
 
 void
@@ -1437,12 +1778,253 @@ Model::apply_layout(Workspace_ptr workspace)
 {
     TRACE();
 
+    // arranging is deferred to the end of the current dispatch, so that the
+    // relayouts requested while handling a single event collapse into one
+    if (std::find(m_dirty_workspaces.begin(), m_dirty_workspaces.end(), workspace)
+        != m_dirty_workspaces.end())
+    {
+        ++m_layout_counters.arranges_coalesced;
+        return;
+    }
+
+    m_dirty_workspaces.push_back(workspace);
+
+    if (!mp_server) {
+        arrange_dirty_workspaces();
+        return;
+    }
+
+    if (!mp_arrange_source && !m_batch_depth)
+        mp_arrange_source = wl_event_loop_add_idle(
+            mp_server->mp_event_loop,
+            Model::handle_arrange,
+            this
+        );
+}
+
+void
+Model::arrange_dirty_workspaces()
+{
+    TRACE();
+
+    if (mp_arrange_source) {
+        wl_event_source_remove(mp_arrange_source);
+        mp_arrange_source = nullptr;
+    }
+
+    if (m_batch_depth || m_dirty_workspaces.empty())
+        return;
+
+    std::vector<Workspace_ptr> dirty_workspaces;
+    dirty_workspaces.swap(m_dirty_workspaces);
+
+    for (Workspace_ptr workspace : dirty_workspaces)
+        arrange_workspace(workspace);
+
+    spdlog::debug(
+        "Layout counters: {} arranges ({} coalesced), {} placements, "
+        "{} configures, {} relayers and {} maps skipped",
+        m_layout_counters.arranges,
+        m_layout_counters.arranges_coalesced,
+        m_layout_counters.placements,
+        m_layout_counters.configures_skipped,
+        m_layout_counters.relayers_skipped,
+        m_layout_counters.maps_skipped
+    );
+}
+
+void
+Model::handle_arrange(void* data)
+{
+    TRACE();
+
+    Model* model = reinterpret_cast<Model*>(data);
+
+    model->mp_arrange_source = nullptr;
+    model->arrange_dirty_workspaces();
+}
+
+void
+Model::arrange_workspace(Workspace_ptr workspace)
+{
+    TRACE();
+
     Output_ptr output = workspace->output();
     if (!output || workspace != output->workspace())
         return;
 
+    ++m_layout_counters.arranges;
+
     for (Placement placement : workspace->arrange(output->placeable_region()))
         place_view(placement);
+
+    if (mp_transaction)
+        mp_transaction->commit();
+
+    update_occlusion(workspace);
+}
+
+Model::LayoutCounters const&
+Model::layout_counters() const
+{
+    return m_layout_counters;
+}
+
+void
+Model::begin_batch()
+{
+    TRACE();
+    ++m_batch_depth;
+}
+
+void
+Model::commit_batch()
+{
+    TRACE();
+
+    if (!m_batch_depth || --m_batch_depth)
+        return;
+
+    // focus is synchronized first, so that any relayout it causes joins the
+    // dirty set and every workspace is arranged once
+    if (m_focus_sync_deferred) {
+        m_focus_sync_deferred = false;
+        sync_focus();
+    }
+
+    arrange_dirty_workspaces();
+}
+
+void
+Model::update_occlusion(Workspace_ptr workspace)
+{
+    TRACE();
+
+    Output_ptr output = workspace->output();
+    if (!output || workspace != output->workspace())
+        return;
+
+    // placements of a workspace awaiting its arrange are stale, the arrange
+    // reevaluates occlusion once they are up to date
+    if (std::find(m_dirty_workspaces.begin(), m_dirty_workspaces.end(), workspace)
+        != m_dirty_workspaces.end())
+    {
+        return;
+    }
+
+    // a focused fullscreen view gets the output to itself, with everything
+    // else disabled so that its buffer can be scanned out directly
+    View_ptr scanout_view = workspace->active();
+    if (scanout_view && (!scanout_view->mapped() || !scanout_view->fullscreen()
+        || scanout_view->contained() || scanout_view->mp_workspace != workspace))
+    {
+        scanout_view = nullptr;
+    }
+
+    if (scanout_view != output->scanout_view())
+        output->set_scanout_view(nullptr);
+
+    // placements only reflect the scene once their configures have been
+    // applied, the transaction reevaluates occlusion when that happens
+    if (transaction_pending(output))
+        return;
+
+    std::vector<Placement> const& placements = workspace->placements();
+
+    if (scanout_view) {
+        output->set_scanout_view(scanout_view);
+
+        for (Placement const& placement : placements)
+            placement.view->set_occluded(placement.view != scanout_view);
+
+        return;
+    }
+
+    m_occluders.clear();
+
+    auto occluded = [this](Region const& region) -> bool {
+        return std::any_of(
+            m_occluders.begin(),
+            m_occluders.end(),
+            [&region](Region const& occluder) {
+                return occluder.contains(region);
+            }
+        );
+    };
+
+    auto eligible = [workspace](Placement const& placement) -> bool {
+        return placement.region && placement.view->mapped()
+            && placement.view->mp_workspace == workspace;
+    };
+
+    // fullscreen views are stacked above all other tracks, but are never
+    // considered to occlude one another
+    for (Placement const& placement : placements)
+        if (placement.method == Placement::PlacementMethod::Fullscreen) {
+            placement.view->set_occluded(false);
+
+            if (eligible(placement) && placement.view->surface_opaque())
+                m_occluders.push_back(*placement.region);
+        }
+
+    // floating views are only ever hidden by fullscreen views
+    for (Placement const& placement : placements)
+        if (placement.method == Placement::PlacementMethod::Free)
+            placement.view->set_occluded(
+                eligible(placement) && occluded(*placement.region)
+            );
+
+    // tiled views are visited from the top of their track downward, each
+    // opaque one hiding whatever it fully covers further down the stack
+    struct wlr_scene_node* tile_layer = workspace->scene_layer(SCENE_LAYER_TILE);
+
+    m_occluded_views.clear();
+
+    struct wlr_scene_node* node;
+    wl_list_for_each_reverse(node, &tile_layer->state.children, state.link) {
+        auto placement = std::find_if(
+            placements.begin(),
+            placements.end(),
+            [node](Placement const& placement) {
+                return placement.view->mp_scene == node
+                    && placement.method == Placement::PlacementMethod::Tile;
+            }
+        );
+
+        if (placement == placements.end() || !eligible(*placement))
+            continue;
+
+        if (occluded(*placement->region)) {
+            m_occluded_views.push_back(placement->view);
+            continue;
+        }
+
+        if (placement->view->surface_opaque())
+            m_occluders.push_back(*placement->region);
+    }
+
+    for (Placement const& placement : placements)
+        if (placement.method == Placement::PlacementMethod::Tile)
+            placement.view->set_occluded(std::find(
+                m_occluded_views.begin(),
+                m_occluded_views.end(),
+                placement.view
+            ) != m_occluded_views.end());
+}
+
+void
+Model::acknowledge_configure(View_ptr view)
+{
+    TRACE();
+
+    if (mp_transaction)
+        mp_transaction->acknowledge(view);
+}
+
+bool
+Model::transaction_pending(Output_ptr output) const
+{
+    return mp_transaction && mp_transaction->pending(output);
 }
 
 void
@@ -1588,54 +2170,50 @@ Model::set_sticky_view(Toggle toggle, View_ptr view)
     switch (toggle) {
     case Toggle::On:
     {
-        if (view->sticky())
+        if (view->sticky() || !view->mp_context)
             return;
 
         if (view->iconified())
             set_iconify_view(Toggle::Off, view);
 
-        std::for_each(
-            m_workspaces.begin(),
-            m_workspaces.end(),
-            [view](Workspace_ptr workspace) {
-                if (workspace != view->mp_workspace)
-                    workspace->add_view(view);
-            }
-        );
+        Workspace_ptr workspace = view->mp_context->workspace();
 
-        // TODO: set sticky state
+        view->set_sticky(true);
+        view->mp_context->register_sticky_view(view);
 
-        Workspace_ptr workspace = view->mp_workspace;
+        if (view->mp_workspace != workspace) {
+            view->mp_workspace->remove_view(view);
+            apply_layout(view->mp_workspace);
 
-        // TODO: view->stick();
-        apply_layout(workspace);
+            workspace->adopt_view(view);
+            view->mp_workspace = workspace;
+        }
 
-        return;
+        view->reparent();
+        view->render_decoration();
+
+        apply_layout(workspace);
+        break;
     }
     case Toggle::Off:
     {
         if (!view->sticky())
             return;
 
-        std::for_each(
-            m_workspaces.begin(),
-            m_workspaces.end(),
-            [=,this](Workspace_ptr workspace) {
-                if (workspace != mp_workspace) {
-                    workspace->remove_view(view);
-                    workspace->remove_icon(view);
-                    workspace->remove_disowned(view);
-                } else
-                    view->mp_workspace = workspace;
-            }
-        );
+        Context_ptr context = view->mp_context;
 
-        // TODO: unset sticky state
+        context->unregister_sticky_view(view);
+        view->set_sticky(false);
+        view->render_decoration();
 
-        // TODO: view->unstick();
-        apply_layout(mp_workspace);
+        if (view->mp_workspace != context->workspace())
+            move_view_to_workspace(view, context->workspace());
+        else {
+            view->reparent();
+            apply_layout(view->mp_workspace);
+        }
 
-        return;
+        break;
     }
     case Toggle::Reverse:
     {
@@ -2169,18 +2747,7 @@ Model::initialize_view(View_ptr view, Workspace_ptr workspace)
 {
     TRACE();
 
-    static std::unordered_map<std::string, Rules>
-        default_rules_memoized{};
-
-    std::optional<Rules> default_rules
-        = Util::const_retrieve(default_rules_memoized, view->handle());
-
-    if (!default_rules)
-        for (auto& [selector,default_rules_] : m_default_rules)
-            if (view_matches_search(view, *selector)) {
-                default_rules_memoized[view->handle()] = default_rules_;
-                default_rules = default_rules_;
-            }
+    std::optional<Rules> default_rules = m_default_rules.match(view);
 
     Rules rules = default_rules
         ? Rules::merge_rules(*default_rules, Rules::parse_rules(view->handle()))
@@ -2219,6 +2786,10 @@ Model::initialize_view(View_ptr view, Workspace_ptr workspace)
 
     if (rules.snap_edges)
         snap_view(view, *rules.snap_edges);
+    if (rules.do_adaptive_sync)
+        view->set_adaptive_sync(*rules.do_adaptive_sync);
+    if (rules.frame_rate)
+        view->set_frame_rate(*rules.frame_rate);
     if (rules.do_fullscreen)
         set_fullscreen_view(*rules.do_fullscreen ? Toggle::On : Toggle::Off, view);
 
@@ -2295,6 +2866,7 @@ Model::destroy_unmanaged(XWaylandUnmanaged_ptr unmanaged)
     TRACE();
 
     m_unmanaged_map.erase(unmanaged->uid());
+    m_spatial_index.erase(unmanaged);
     spdlog::info("Destroyed unmanaged X client {}", unmanaged->uid_formatted());
 
     delete unmanaged;
@@ -2307,7 +2879,11 @@ Model::register_view(View_ptr view, Workspace_ptr workspace)
     TRACE();
 
     initialize_view(view, workspace);
+    m_search_index.insert(view);
     spdlog::info("Registered view {}", view->uid_formatted());
+
+    if (mp_server->mp_ipc_server)
+        mp_server->mp_ipc_server->emit_view_registered(view);
     sync_focus();
 }
 
@@ -2316,12 +2892,31 @@ Model::unregister_view(View_ptr view)
 {
     TRACE();
 
+    if (mp_transaction)
+        mp_transaction->remove(view);
+
+    if (view->sticky() && view->mp_context)
+        view->mp_context->unregister_sticky_view(view);
+
+    m_search_index.erase(view);
+    m_spatial_index.erase(view);
+    mp_server->mp_seat->mp_cursor->forget_view(view);
+
+    for (Output_ptr output : m_outputs)
+        if (output->scanout_view() == view)
+            output->set_scanout_view(nullptr);
+
     if (view->mp_workspace) {
         view->mp_workspace->remove_view(view);
         apply_layout(view->mp_workspace);
     }
 
     spdlog::info("Unregistered view {}", view->uid_formatted());
+
+    if (mp_server->mp_ipc_server)
+        mp_server->mp_ipc_server->emit_view_unregistered(view);
+
+    arrange_dirty_workspaces();
     mp_output->focus_at_cursor();
     sync_focus();
 }
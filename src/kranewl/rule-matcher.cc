@@ -0,0 +1,250 @@
+#include <trace.hh>
+
+#include <kranewl/rule-matcher.hh>
+
+#include <kranewl/tree/view.hh>
+
+#include <algorithm>
+#include <deque>
+
+RuleMatcher::RuleMatcher()
+    : m_rules({}),
+      m_exact({}),
+      m_contains({}),
+      m_memo({}),
+      m_memo_map({})
+{}
+
+RuleMatcher::~RuleMatcher()
+{}
+
+bool
+RuleMatcher::add_rule(
+    SearchSelector::SelectionCriterium criterium,
+    std::string const& pattern,
+    Rules const& rules
+)
+{
+    TRACE();
+
+    Index index = m_rules.size();
+
+    // later rules take precedence over earlier ones, hence the
+    // unconditional overwrite and the maximum over matching indices
+    switch (criterium) {
+    case SearchSelector::SelectionCriterium::ByTitleEquals:    m_exact[0][pattern] = index;          break;
+    case SearchSelector::SelectionCriterium::ByAppIdEquals:    m_exact[1][pattern] = index;          break;
+    case SearchSelector::SelectionCriterium::ByHandleEquals:   m_exact[2][pattern] = index;          break;
+    case SearchSelector::SelectionCriterium::ByTitleContains:  m_contains[0].insert(pattern, index); break;
+    case SearchSelector::SelectionCriterium::ByAppIdContains:  m_contains[1].insert(pattern, index); break;
+    case SearchSelector::SelectionCriterium::ByHandleContains: m_contains[2].insert(pattern, index); break;
+    default: return false;
+    }
+
+    m_rules.push_back(rules);
+    clear_memo();
+
+    return true;
+}
+
+void
+RuleMatcher::compile()
+{
+    TRACE();
+
+    for (Automaton& automaton : m_contains)
+        automaton.compile();
+
+    clear_memo();
+}
+
+std::optional<Rules>
+RuleMatcher::match(View_ptr view)
+{
+    return match(view->title(), view->app_id(), view->handle());
+}
+
+std::optional<Rules>
+RuleMatcher::match(
+    std::string const& title,
+    std::string const& app_id,
+    std::string const& handle
+)
+{
+    TRACE();
+
+    if (m_rules.empty())
+        return std::nullopt;
+
+    std::string key;
+    key.reserve(title.size() + app_id.size() + handle.size() + 2);
+    key.append(title).push_back('\0');
+    key.append(app_id).push_back('\0');
+    key.append(handle);
+
+    Index index;
+    auto memoized = m_memo_map.find(key);
+
+    if (memoized != m_memo_map.end()) {
+        m_memo.splice(m_memo.begin(), m_memo, memoized->second);
+        index = memoized->second->second;
+    } else {
+        index = match_index(title, app_id, handle);
+
+        if (m_memo.size() >= MEMO_CAPACITY) {
+            m_memo_map.erase(m_memo.back().first);
+            m_memo.pop_back();
+        }
+
+        m_memo.emplace_front(key, index);
+        m_memo_map.emplace(std::move(key), m_memo.begin());
+    }
+
+    if (index == NO_RULE)
+        return std::nullopt;
+
+    return m_rules[index];
+}
+
+void
+RuleMatcher::clear_memo()
+{
+    m_memo.clear();
+    m_memo_map.clear();
+}
+
+Index
+RuleMatcher::match_index(
+    std::string const& title,
+    std::string const& app_id,
+    std::string const& handle
+) const
+{
+    std::array<std::string const*, KEY_COUNT> values = { &title, &app_id, &handle };
+    Index best = NO_RULE;
+
+    auto prefer = [&best](Index index) {
+        if (index != NO_RULE && (best == NO_RULE || index > best))
+            best = index;
+    };
+
+    for (std::size_t i = 0; i < KEY_COUNT; ++i) {
+        auto exact = m_exact[i].find(*values[i]);
+
+        if (exact != m_exact[i].end())
+            prefer(exact->second);
+
+        prefer(m_contains[i].search(*values[i]));
+    }
+
+    return best;
+}
+
+RuleMatcher::Automaton::Automaton()
+    : nodes({Node{{}, 0, NO_RULE}})
+{}
+
+Index
+RuleMatcher::Automaton::child(Index node, unsigned char c) const
+{
+    auto const& edges = nodes[node].edges;
+    auto edge = std::lower_bound(
+        edges.begin(),
+        edges.end(),
+        c,
+        [](auto const& edge, unsigned char c) { return edge.first < c; }
+    );
+
+    if (edge == edges.end() || edge->first != c)
+        return NO_RULE;
+
+    return edge->second;
+}
+
+void
+RuleMatcher::Automaton::insert(std::string const& pattern, Index rule)
+{
+    Index node = 0;
+
+    for (unsigned char c : pattern) {
+        Index next = child(node, c);
+
+        if (next == NO_RULE) {
+            next = nodes.size();
+            nodes.push_back(Node{{}, 0, NO_RULE});
+
+            auto& edges = nodes[node].edges;
+            edges.insert(
+                std::lower_bound(
+                    edges.begin(),
+                    edges.end(),
+                    c,
+                    [](auto const& edge, unsigned char c) { return edge.first < c; }
+                ),
+                {c, next}
+            );
+        }
+
+        node = next;
+    }
+
+    nodes[node].best = rule;
+}
+
+void
+RuleMatcher::Automaton::compile()
+{
+    std::deque<Index> queue = {};
+
+    for (auto const& [_,next] : nodes[0].edges) {
+        nodes[next].fail = 0;
+        queue.push_back(next);
+    }
+
+    while (!queue.empty()) {
+        Index node = queue.front();
+        queue.pop_front();
+
+        Index fail = nodes[node].fail;
+        if (nodes[fail].best != NO_RULE
+            && (nodes[node].best == NO_RULE || nodes[fail].best > nodes[node].best))
+        {
+            nodes[node].best = nodes[fail].best;
+        }
+
+        for (auto const& [c,next] : nodes[node].edges) {
+            Index state = fail;
+            Index target;
+
+            while ((target = child(state, c)) == NO_RULE && state != 0)
+                state = nodes[state].fail;
+
+            nodes[next].fail = target != NO_RULE ? target : 0;
+            queue.push_back(next);
+        }
+    }
+}
+
+Index
+RuleMatcher::Automaton::search(std::string const& text) const
+{
+    Index best = nodes[0].best;
+
+    if (nodes.size() == 1)
+        return best;
+
+    Index node = 0;
+    for (unsigned char c : text) {
+        Index next;
+
+        while ((next = child(node, c)) == NO_RULE && node != 0)
+            node = nodes[node].fail;
+
+        node = next != NO_RULE ? next : 0;
+
+        if (nodes[node].best != NO_RULE && (best == NO_RULE || nodes[node].best > best))
+            best = nodes[node].best;
+    }
+
+    return best;
+}
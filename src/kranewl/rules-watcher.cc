@@ -0,0 +1,127 @@
+#include <trace.hh>
+
+#include <kranewl/rules-watcher.hh>
+
+#include <kranewl/model.hh>
+#include <kranewl/server.hh>
+
+#include <spdlog/spdlog.h>
+
+#include <cerrno>
+#include <cstring>
+
+extern "C" {
+#include <sys/inotify.h>
+#include <unistd.h>
+}
+
+// editors tend to replace files by renaming a fresh copy over them, so the
+// parent directory is watched rather than the (soon stale) file inode
+static constexpr uint32_t WATCH_MASK
+    = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_MOVED_FROM;
+
+RulesWatcher::RulesWatcher(Server_ptr server, Model_ptr model, std::string const& rules_path)
+    : mp_server(server),
+      mp_model(model),
+      m_rules_path(rules_path),
+      m_rules_name({}),
+      m_inotify_fd(-1),
+      m_watch_descriptor(-1),
+      mp_inotify_source(nullptr),
+      mp_debounce_source(nullptr)
+{
+    TRACE();
+
+    std::string::size_type pos = m_rules_path.rfind('/');
+    std::string directory = pos == std::string::npos
+        ? "."
+        : pos == 0 ? "/" : m_rules_path.substr(0, pos);
+
+    m_rules_name = pos == std::string::npos
+        ? m_rules_path
+        : m_rules_path.substr(pos + 1);
+
+    m_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify_fd < 0) {
+        spdlog::error("Could not initialize inotify: {}", std::strerror(errno));
+        return;
+    }
+
+    m_watch_descriptor = inotify_add_watch(m_inotify_fd, directory.c_str(), WATCH_MASK);
+    if (m_watch_descriptor < 0) {
+        spdlog::error("Could not watch {}: {}", directory, std::strerror(errno));
+        close(m_inotify_fd);
+        m_inotify_fd = -1;
+        return;
+    }
+
+    mp_inotify_source = wl_event_loop_add_fd(
+        mp_server->mp_event_loop,
+        m_inotify_fd,
+        WL_EVENT_READABLE,
+        RulesWatcher::handle_inotify,
+        this
+    );
+
+    mp_debounce_source = wl_event_loop_add_timer(
+        mp_server->mp_event_loop,
+        RulesWatcher::handle_debounce,
+        this
+    );
+
+    spdlog::info("Watching {} for changes", m_rules_path);
+}
+
+RulesWatcher::~RulesWatcher()
+{
+    if (mp_debounce_source)
+        wl_event_source_remove(mp_debounce_source);
+
+    if (mp_inotify_source)
+        wl_event_source_remove(mp_inotify_source);
+
+    if (m_inotify_fd >= 0)
+        close(m_inotify_fd);
+}
+
+int
+RulesWatcher::handle_inotify(int fd, uint32_t, void* data)
+{
+    TRACE();
+
+    RulesWatcher_ptr watcher = reinterpret_cast<RulesWatcher_ptr>(data);
+
+    alignas(struct inotify_event) char buffer[4096];
+    bool changed = false;
+    ssize_t length;
+
+    while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+        for (char* ptr = buffer; ptr < buffer + length;) {
+            struct inotify_event const* event
+                = reinterpret_cast<struct inotify_event const*>(ptr);
+
+            if (event->len && watcher->m_rules_name == event->name)
+                changed = true;
+
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    // coalesce the burst of events a single save produces into one reload
+    if (changed && watcher->mp_debounce_source)
+        if (wl_event_source_timer_update(watcher->mp_debounce_source, DEBOUNCE.count()) < 0)
+            spdlog::error("Could not arm rules reload timer");
+
+    return 0;
+}
+
+int
+RulesWatcher::handle_debounce(void* data)
+{
+    TRACE();
+
+    RulesWatcher_ptr watcher = reinterpret_cast<RulesWatcher_ptr>(data);
+    watcher->mp_model->reload_user_default_rules();
+
+    return 0;
+}
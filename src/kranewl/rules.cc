@@ -1,22 +1,21 @@
 #include <kranewl/rules.hh>
 #include <kranewl/env.hh>
+#include <kranewl/rule-matcher.hh>
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <fstream>
 
-std::vector<std::tuple<SearchSelector_ptr, Rules>>
-Rules::compile_default_rules(std::string const& rules_path)
+bool
+Rules::compile_default_rules(std::string const& rules_path, RuleMatcher& default_rules)
 {
-    std::vector<std::tuple<SearchSelector_ptr, Rules>>
-        default_rules = {};
-
     if (!file_exists(rules_path))
-        return default_rules;
+        return false;
 
     std::ifstream rules_if(rules_path);
     if (!rules_if.good())
-        return default_rules;
+        return false;
 
     std::string line;
 
@@ -79,13 +78,11 @@ Rules::compile_default_rules(std::string const& rules_path)
         default: continue;
         }
 
-        default_rules.push_back({
-            new SearchSelector{criterium, line.substr(3)},
-            Rules::parse_rules(rules, true)
-        });
+        default_rules.add_rule(criterium, line.substr(3), Rules::parse_rules(rules, true));
     }
 
-    return default_rules;
+    default_rules.compile();
+    return true;
 }
 
 Rules
@@ -120,11 +117,28 @@ Rules::parse_rules(std::string_view rule, bool ignore_prefix)
     bool next_output = false;
     bool next_context = false;
     bool next_workspace = false;
+    bool next_frame_rate = false;
 
     std::optional<decltype(snapedge_list_handler)>
         list_handler = std::nullopt;
 
+    // a frame rate ends at the first non-digit, out-of-range values are dropped
+    auto end_frame_rate = [&]() {
+        if (!next_frame_rate)
+            return;
+
+        next_frame_rate = false;
+
+        if (!*rules.frame_rate || *rules.frame_rate > MAX_FRAME_RATE) {
+            spdlog::warn("Ignoring frame rate outside of [1, {}]", MAX_FRAME_RATE);
+            rules.frame_rate = std::nullopt;
+        }
+    };
+
     for (; iter != rule.end(); ++iter) {
+        if (next_frame_rate && (*iter < '0' || *iter > '9'))
+            end_frame_rate();
+
         if (*iter == '.') {
             list_handler = std::nullopt;
             continue;
@@ -140,10 +154,20 @@ Rules::parse_rules(std::string_view rule, bool ignore_prefix)
         case 'O': next_output = true;            continue;
         case 'C': next_context = true;           continue;
         case 'W': next_workspace = true;         continue;
+        case 'R':
+        {
+            next_output = false;
+            next_context = false;
+            next_workspace = false;
+            next_frame_rate = true;
+            rules.frame_rate = 0;
+            continue;
+        }
         case '@': rules.do_focus = !invert;      break;
         case 'f': rules.do_float = !invert;      break;
         case 'F': rules.do_fullscreen = !invert; break;
         case 'c': rules.do_center = !invert;     break;
+        case 'V': rules.do_adaptive_sync = !invert; break;
         case '0': // fallthrough
         case '1': // fallthrough
         case '2': // fallthrough
@@ -155,6 +179,17 @@ Rules::parse_rules(std::string_view rule, bool ignore_prefix)
         case '8': // fallthrough
         case '9':
         {
+            // frame rates span multiple digits, e.g., R30 caps at 30 Hz
+            if (next_frame_rate) {
+                // saturate, so that long digit runs cannot wrap into range
+                rules.frame_rate = std::min(
+                    *rules.frame_rate * 10 + (*iter - '0'),
+                    MAX_FRAME_RATE + 1
+                );
+
+                continue;
+            }
+
             if (next_output)
                 rules.to_output = *iter - '0';
             if (next_context)
@@ -180,6 +215,7 @@ Rules::parse_rules(std::string_view rule, bool ignore_prefix)
         next_workspace = false;
     }
 
+    end_frame_rate();
     return rules;
 }
 
@@ -205,6 +241,10 @@ Rules::merge_rules(Rules const& base, Rules const& merger)
         rules.to_workspace = merger.to_workspace;
     if (merger.snap_edges)
         rules.snap_edges = merger.snap_edges;
+    if (merger.do_adaptive_sync)
+        rules.do_adaptive_sync = merger.do_adaptive_sync;
+    if (merger.frame_rate)
+        rules.frame_rate = merger.frame_rate;
 
     return rules;
 }
@@ -0,0 +1,248 @@
+#include <trace.hh>
+
+#include <kranewl/search-index.hh>
+
+#include <kranewl/tree/view.hh>
+#include <kranewl/util.hh>
+
+#include <algorithm>
+
+SearchIndex::SearchIndex()
+    : m_entries({}),
+      m_values({}),
+      m_trigrams({}),
+      m_mru({}),
+      m_touches(0),
+      m_trigram_buffer({})
+{}
+
+SearchIndex::~SearchIndex()
+{}
+
+void
+SearchIndex::insert(View_ptr view)
+{
+    TRACE();
+
+    if (m_entries.contains(view))
+        return;
+
+    m_mru.push_front(view);
+
+    Entry& entry = m_entries[view];
+    entry.mru_position = m_mru.begin();
+    entry.last_touched = ++m_touches;
+
+    for (std::size_t i = 0; i < KEY_COUNT; ++i) {
+        Key key = static_cast<Key>(i);
+
+        entry.values[i] = value_of(view, key);
+        index_value(view, key, entry.values[i]);
+    }
+}
+
+void
+SearchIndex::update(View_ptr view)
+{
+    TRACE();
+
+    auto entry = m_entries.find(view);
+    if (entry == m_entries.end())
+        return;
+
+    for (std::size_t i = 0; i < KEY_COUNT; ++i) {
+        Key key = static_cast<Key>(i);
+        std::string const& value = value_of(view, key);
+
+        if (value == entry->second.values[i])
+            continue;
+
+        unindex_value(view, key, entry->second.values[i]);
+        entry->second.values[i] = value;
+        index_value(view, key, entry->second.values[i]);
+    }
+}
+
+void
+SearchIndex::erase(View_ptr view)
+{
+    TRACE();
+
+    auto entry = m_entries.find(view);
+    if (entry == m_entries.end())
+        return;
+
+    for (std::size_t i = 0; i < KEY_COUNT; ++i)
+        unindex_value(view, static_cast<Key>(i), entry->second.values[i]);
+
+    m_mru.erase(entry->second.mru_position);
+    m_entries.erase(entry);
+}
+
+void
+SearchIndex::touch(View_ptr view)
+{
+    auto entry = m_entries.find(view);
+    if (entry == m_entries.end())
+        return;
+
+    m_mru.splice(m_mru.begin(), m_mru, entry->second.mru_position);
+    entry->second.last_touched = ++m_touches;
+}
+
+View_ptr
+SearchIndex::find_equal(Key key, std::string const& value) const
+{
+    TRACE();
+
+    auto const& values = m_values[static_cast<std::size_t>(key)];
+
+    auto views = values.find(value);
+    if (views == values.end())
+        return nullptr;
+
+    return most_recent(views->second, key, nullptr);
+}
+
+View_ptr
+SearchIndex::find_containing(Key key, std::string const& value) const
+{
+    TRACE();
+
+    if (value.size() < 3) {
+        std::size_t i = static_cast<std::size_t>(key);
+
+        for (View_ptr view : m_mru)
+            if (m_entries.at(view).values[i].find(value) != std::string::npos)
+                return view;
+
+        return nullptr;
+    }
+
+    extract_trigrams(key, value, m_trigram_buffer);
+
+    std::vector<View_ptr> const* candidates = nullptr;
+    for (Trigram trigram : m_trigram_buffer) {
+        auto views = m_trigrams.find(trigram);
+
+        if (views == m_trigrams.end())
+            return nullptr;
+
+        if (!candidates || views->second.size() < candidates->size())
+            candidates = &views->second;
+    }
+
+    return most_recent(*candidates, key, &value);
+}
+
+View_ptr
+SearchIndex::find_most_recent(std::function<bool(const View_ptr)> const& filter) const
+{
+    TRACE();
+
+    for (View_ptr view : m_mru)
+        if (filter(view))
+            return view;
+
+    return nullptr;
+}
+
+std::string const&
+SearchIndex::value_of(View_ptr view, Key key)
+{
+    switch (key) {
+    case Key::Title:  return view->title();
+    case Key::AppId:  return view->app_id();
+    case Key::Handle: return view->handle();
+    }
+
+    return view->handle();
+}
+
+void
+SearchIndex::extract_trigrams(
+    Key key,
+    std::string const& value,
+    std::vector<Trigram>& trigrams
+)
+{
+    trigrams.clear();
+
+    if (value.size() < 3)
+        return;
+
+    for (std::size_t i = 0; i + 2 < value.size(); ++i)
+        trigrams.push_back(
+            static_cast<Trigram>(key) << 24
+            | static_cast<Trigram>(static_cast<unsigned char>(value[i])) << 16
+            | static_cast<Trigram>(static_cast<unsigned char>(value[i + 1])) << 8
+            | static_cast<Trigram>(static_cast<unsigned char>(value[i + 2]))
+        );
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+void
+SearchIndex::index_value(View_ptr view, Key key, std::string const& value)
+{
+    m_values[static_cast<std::size_t>(key)][value].push_back(view);
+
+    extract_trigrams(key, value, m_trigram_buffer);
+    for (Trigram trigram : m_trigram_buffer)
+        m_trigrams[trigram].push_back(view);
+}
+
+void
+SearchIndex::unindex_value(View_ptr view, Key key, std::string const& value)
+{
+    auto& values = m_values[static_cast<std::size_t>(key)];
+
+    auto views = values.find(value);
+    if (views != values.end()) {
+        Util::erase_remove(views->second, view);
+
+        if (views->second.empty())
+            values.erase(views);
+    }
+
+    extract_trigrams(key, value, m_trigram_buffer);
+    for (Trigram trigram : m_trigram_buffer) {
+        auto views = m_trigrams.find(trigram);
+
+        if (views != m_trigrams.end()) {
+            Util::erase_remove(views->second, view);
+
+            if (views->second.empty())
+                m_trigrams.erase(views);
+        }
+    }
+}
+
+View_ptr
+SearchIndex::most_recent(
+    std::vector<View_ptr> const& views,
+    Key key,
+    std::string const* contained
+) const
+{
+    View_ptr most_recent = nullptr;
+    std::uint64_t last_touched = 0;
+
+    for (View_ptr view : views) {
+        Entry const& entry = m_entries.at(view);
+
+        if (contained && entry.values[static_cast<std::size_t>(key)].find(*contained)
+                == std::string::npos)
+        {
+            continue;
+        }
+
+        if (entry.last_touched > last_touched) {
+            most_recent = view;
+            last_touched = entry.last_touched;
+        }
+    }
+
+    return most_recent;
+}
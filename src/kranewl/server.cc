@@ -2,12 +2,15 @@
 
 #include <kranewl/server.hh>
 
+#include <kranewl/context.hh>
 #include <kranewl/exec.hh>
 #include <kranewl/input/keyboard.hh>
+#include <kranewl/ipc-server.hh>
 #include <kranewl/model.hh>
 #include <kranewl/tree/output.hh>
 #include <kranewl/tree/view.hh>
 #include <kranewl/tree/xdg-view.hh>
+#include <kranewl/workspace.hh>
 #include <kranewl/xdg-decoration.hh>
 #ifdef XWAYLAND
 #include <kranewl/tree/xwayland-view.hh>
@@ -122,6 +125,7 @@ Server::~Server()
 {
     TRACE();
 
+    delete mp_ipc_server;
     delete mp_seat;
 #ifdef XWAYLAND
     delete mp_xwayland;
@@ -196,6 +200,12 @@ Server::initialize()
         &wlr_scene_tree_create(&mp_scene->node)->node
     };
 
+    for (Workspace_ptr workspace : mp_model->workspaces())
+        workspace->create_scene_layers(m_scene_layers);
+
+    for (Context_ptr context : mp_model->contexts())
+        context->create_scene_layers(m_scene_layers);
+
     struct wlr_cursor* cursor = wlr_cursor_create();
     wlr_cursor_attach_output_layout(cursor, mp_output_layout);
     mp_seat = new Seat(
@@ -218,6 +228,7 @@ Server::initialize()
     mp_xdg_activation = wlr_xdg_activation_v1_create(mp_display);
     mp_xdg_shell = wlr_xdg_shell_create(mp_display);
     mp_presentation = wlr_presentation_create(mp_display, mp_backend);
+    wlr_scene_set_presentation(mp_scene, mp_presentation);
     mp_server_decoration_manager = wlr_server_decoration_manager_create(mp_display);
     mp_xdg_decoration_manager = wlr_xdg_decoration_manager_v1_create(mp_display);
     mp_virtual_keyboard_manager = wlr_virtual_keyboard_manager_v1_create(mp_display);
@@ -262,6 +273,10 @@ Server::initialize()
     setenv("XDG_CURRENT_DESKTOP", "kranewl", true);
 
     spdlog::info("Server initialized at WAYLAND_DISPLAY={}", m_socket);
+
+    mp_ipc_server = new IPCServer(this, mp_model);
+    if (!mp_ipc_server->listen(m_socket))
+        spdlog::warn("IPC will not be available");
 }
 
 void
@@ -637,7 +652,13 @@ Server::handle_new_xdg_surface(struct wl_listener* listener, void* data)
         );
 
         XDGView_ptr view;
-        if (!(view = xdg_view_from_popup(xdg_surface->popup)) || !view->mp_output)
+        if (!(view = xdg_view_from_popup(xdg_surface->popup)))
+            return;
+
+        // popups may extend beyond their toplevel's region
+        server->mp_model->spatial_index().set_unbounded(view, true);
+
+        if (!view->mp_output)
             return;
 
         Region const& active_region = view->active_region();
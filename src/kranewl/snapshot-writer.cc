@@ -0,0 +1,79 @@
+#include <trace.hh>
+
+#include <kranewl/snapshot-writer.hh>
+
+#include <spdlog/spdlog.h>
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+extern "C" {
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+}
+
+SnapshotWriter::SnapshotWriter()
+    : m_fd(-1),
+      mp_snapshot(nullptr)
+{
+    TRACE();
+
+    m_fd = memfd_create("kranewl-snapshot", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (m_fd < 0) {
+        spdlog::error("Could not create state snapshot: {}", std::strerror(errno));
+        return;
+    }
+
+    void* memory = MAP_FAILED;
+    if (ftruncate(m_fd, sizeof(IPC::Snapshot)) < 0
+        || (memory = mmap(nullptr, sizeof(IPC::Snapshot), PROT_READ | PROT_WRITE,
+                MAP_SHARED, m_fd, 0)) == MAP_FAILED)
+    {
+        spdlog::error("Could not map state snapshot: {}", std::strerror(errno));
+        close(m_fd);
+        m_fd = -1;
+        return;
+    }
+
+    mp_snapshot = new (memory) IPC::Snapshot{};
+    mp_snapshot->magic = IPC::SNAPSHOT_MAGIC;
+    mp_snapshot->version = IPC::SNAPSHOT_VERSION;
+
+    // readers receive this very descriptor, so it is sealed against resizing
+    // and against any writable mapping other than the one made above
+    int seals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL;
+#ifdef F_SEAL_FUTURE_WRITE
+    seals |= F_SEAL_FUTURE_WRITE;
+#endif
+
+    if (fcntl(m_fd, F_ADD_SEALS, seals) < 0)
+        spdlog::warn("Could not seal state snapshot: {}", std::strerror(errno));
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+    if (mp_snapshot)
+        munmap(mp_snapshot, sizeof(IPC::Snapshot));
+
+    if (m_fd >= 0)
+        close(m_fd);
+}
+
+IPC::Snapshot::State&
+SnapshotWriter::begin()
+{
+    std::uint32_t sequence = mp_snapshot->sequence.load(std::memory_order_relaxed);
+    mp_snapshot->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return mp_snapshot->state;
+}
+
+void
+SnapshotWriter::end()
+{
+    std::uint32_t sequence = mp_snapshot->sequence.load(std::memory_order_relaxed);
+    mp_snapshot->sequence.store(sequence + 1, std::memory_order_release);
+}
@@ -0,0 +1,177 @@
+#include <trace.hh>
+
+#include <kranewl/spatial-index.hh>
+
+#include <kranewl/util.hh>
+
+SpatialIndex::SpatialIndex()
+    : m_entries({}),
+      m_cells({}),
+      m_uncelled({})
+{}
+
+SpatialIndex::~SpatialIndex()
+{}
+
+void
+SpatialIndex::insert(
+    Node_ptr node,
+    struct wlr_scene_node* scene,
+    SceneLayer layer,
+    Region const& region
+)
+{
+    TRACE();
+
+    auto [iter,inserted] = m_entries.try_emplace(node, Entry{
+        .node = node,
+        .scene = scene,
+        .layer = layer,
+        .region = region,
+        .unbounded = false,
+        .celled = false,
+        .cell_x0 = 0,
+        .cell_y0 = 0,
+        .cell_x1 = 0,
+        .cell_y1 = 0,
+    });
+
+    Entry& entry = iter->second;
+
+    if (!inserted) {
+        entry.scene = scene;
+        entry.layer = layer;
+
+        if (entry.region == region)
+            return;
+
+        unlink(entry);
+        entry.region = region;
+    }
+
+    link(entry);
+}
+
+void
+SpatialIndex::relayer(Node_ptr node, SceneLayer layer)
+{
+    auto entry = m_entries.find(node);
+    if (entry != m_entries.end())
+        entry->second.layer = layer;
+}
+
+void
+SpatialIndex::set_unbounded(Node_ptr node, bool unbounded)
+{
+    TRACE();
+
+    auto entry = m_entries.find(node);
+    if (entry == m_entries.end() || entry->second.unbounded == unbounded)
+        return;
+
+    unlink(entry->second);
+    entry->second.unbounded = unbounded;
+    link(entry->second);
+}
+
+void
+SpatialIndex::erase(Node_ptr node)
+{
+    TRACE();
+
+    auto entry = m_entries.find(node);
+    if (entry == m_entries.end())
+        return;
+
+    unlink(entry->second);
+    m_entries.erase(entry);
+}
+
+void
+SpatialIndex::query(Pos pos, std::vector<Entry const*>& entries) const
+{
+    entries.clear();
+
+    auto cell = m_cells.find(cell_key(cell_of(pos.x), cell_of(pos.y)));
+    if (cell != m_cells.end())
+        for (Entry const* entry : cell->second)
+            if (entry->region.contains(pos))
+                entries.push_back(entry);
+
+    for (Entry const* entry : m_uncelled)
+        if (entry->unbounded || entry->region.contains(pos))
+            entries.push_back(entry);
+}
+
+std::uint64_t
+SpatialIndex::cell_key(int x, int y)
+{
+    return static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32
+        | static_cast<std::uint32_t>(y);
+}
+
+int
+SpatialIndex::cell_of(int coordinate)
+{
+    return coordinate >= 0
+        ? coordinate / CELL_SIZE
+        : (coordinate - CELL_SIZE + 1) / CELL_SIZE;
+}
+
+void
+SpatialIndex::link(Entry& entry)
+{
+    Region const& region = entry.region;
+    entry.celled = false;
+
+    if (region.dim.w <= 0 || region.dim.h <= 0) {
+        if (entry.unbounded)
+            m_uncelled.push_back(&entry);
+
+        return;
+    }
+
+    entry.cell_x0 = cell_of(region.pos.x);
+    entry.cell_y0 = cell_of(region.pos.y);
+    entry.cell_x1 = cell_of(region.pos.x + region.dim.w - 1);
+    entry.cell_y1 = cell_of(region.pos.y + region.dim.h - 1);
+
+    // entries that would occupy an excessive number of cells, as well as those
+    // whose content may extend beyond their region, are tested on every query
+    if (entry.unbounded
+        || entry.cell_x1 - entry.cell_x0 >= MAX_CELL_SPAN
+        || entry.cell_y1 - entry.cell_y0 >= MAX_CELL_SPAN)
+    {
+        m_uncelled.push_back(&entry);
+        return;
+    }
+
+    entry.celled = true;
+    for (int x = entry.cell_x0; x <= entry.cell_x1; ++x)
+        for (int y = entry.cell_y0; y <= entry.cell_y1; ++y)
+            m_cells[cell_key(x, y)].push_back(&entry);
+}
+
+void
+SpatialIndex::unlink(Entry& entry)
+{
+    if (!entry.celled) {
+        Util::erase_remove(m_uncelled, &entry);
+        return;
+    }
+
+    for (int x = entry.cell_x0; x <= entry.cell_x1; ++x)
+        for (int y = entry.cell_y0; y <= entry.cell_y1; ++y) {
+            auto cell = m_cells.find(cell_key(x, y));
+
+            if (cell == m_cells.end())
+                continue;
+
+            Util::erase_remove(cell->second, &entry);
+
+            if (cell->second.empty())
+                m_cells.erase(cell);
+        }
+
+    entry.celled = false;
+}
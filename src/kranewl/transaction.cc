@@ -0,0 +1,212 @@
+#include <trace.hh>
+
+#include <kranewl/transaction.hh>
+
+#include <kranewl/context.hh>
+#include <kranewl/model.hh>
+#include <kranewl/server.hh>
+#include <kranewl/tree/output.hh>
+#include <kranewl/tree/view.hh>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+Transaction::Transaction(Server_ptr server, Model_ptr model)
+    : mp_server(server),
+      mp_model(model),
+      m_instructions({}),
+      m_awaiting_acks(0),
+      m_timeout_armed(false),
+      mp_timeout_source(nullptr)
+{}
+
+Transaction::~Transaction()
+{
+    if (mp_timeout_source)
+        wl_event_source_remove(mp_timeout_source);
+}
+
+void
+Transaction::add(View_ptr view, Region const& region, Extents const& extents)
+{
+    TRACE();
+
+    bool awaiting_ack = view->send_configure(region, extents);
+
+    auto instruction = std::find_if(
+        m_instructions.begin(),
+        m_instructions.end(),
+        [view](Instruction const& instruction) {
+            return instruction.view == view;
+        }
+    );
+
+    if (instruction == m_instructions.end()) {
+        m_instructions.push_back(Instruction{
+            .view = view,
+            .region = region,
+            .extents = extents,
+            .awaiting_ack = awaiting_ack
+        });
+
+        if (awaiting_ack)
+            ++m_awaiting_acks;
+
+        return;
+    }
+
+    instruction->region = region;
+    instruction->extents = extents;
+
+    if (awaiting_ack && !instruction->awaiting_ack) {
+        instruction->awaiting_ack = true;
+        ++m_awaiting_acks;
+    }
+}
+
+void
+Transaction::remove(View_ptr view)
+{
+    TRACE();
+
+    auto instruction = std::find_if(
+        m_instructions.begin(),
+        m_instructions.end(),
+        [view](Instruction const& instruction) {
+            return instruction.view == view;
+        }
+    );
+
+    if (instruction == m_instructions.end())
+        return;
+
+    if (instruction->awaiting_ack)
+        --m_awaiting_acks;
+
+    m_instructions.erase(instruction);
+
+    if (!m_instructions.empty() && !m_awaiting_acks)
+        apply();
+}
+
+void
+Transaction::acknowledge(View_ptr view)
+{
+    TRACE();
+
+    auto instruction = std::find_if(
+        m_instructions.begin(),
+        m_instructions.end(),
+        [view](Instruction const& instruction) {
+            return instruction.view == view;
+        }
+    );
+
+    if (instruction == m_instructions.end() || !instruction->awaiting_ack)
+        return;
+
+    instruction->awaiting_ack = false;
+
+    if (!--m_awaiting_acks)
+        apply();
+}
+
+void
+Transaction::commit()
+{
+    TRACE();
+
+    if (m_instructions.empty())
+        return;
+
+    if (!m_awaiting_acks) {
+        apply();
+        return;
+    }
+
+    if (!mp_timeout_source)
+        mp_timeout_source = wl_event_loop_add_timer(
+            mp_server->mp_event_loop,
+            Transaction::handle_timeout,
+            this
+        );
+
+    if (!m_timeout_armed) {
+        if (wl_event_source_timer_update(mp_timeout_source, TIMEOUT.count()) < 0)
+            spdlog::error("Could not arm transaction timer");
+        else
+            m_timeout_armed = true;
+    }
+}
+
+bool
+Transaction::pending() const
+{
+    return !m_instructions.empty();
+}
+
+bool
+Transaction::pending(Output_ptr output) const
+{
+    return std::any_of(
+        m_instructions.begin(),
+        m_instructions.end(),
+        [output](Instruction const& instruction) {
+            return instruction.view->mp_context
+                && instruction.view->mp_context->output() == output;
+        }
+    );
+}
+
+int
+Transaction::handle_timeout(void* data)
+{
+    TRACE();
+
+    Transaction_ptr transaction = reinterpret_cast<Transaction_ptr>(data);
+
+    spdlog::warn(
+        "Transaction timed out with {} outstanding configures",
+        transaction->m_awaiting_acks
+    );
+
+    transaction->m_timeout_armed = false;
+    transaction->apply();
+
+    return 0;
+}
+
+void
+Transaction::apply()
+{
+    TRACE();
+
+    if (m_timeout_armed) {
+        if (wl_event_source_timer_update(mp_timeout_source, 0) < 0)
+            spdlog::error("Could not disarm transaction timer");
+
+        m_timeout_armed = false;
+    }
+
+    std::vector<Workspace_ptr> workspaces;
+
+    for (Instruction const& instruction : m_instructions) {
+        if (instruction.view->configured_as(instruction.region, instruction.extents))
+            instruction.view->apply_configure(instruction.region, instruction.extents);
+
+        Workspace_ptr workspace = instruction.view->mp_workspace;
+        if (workspace && std::find(workspaces.begin(), workspaces.end(), workspace)
+            == workspaces.end())
+        {
+            workspaces.push_back(workspace);
+        }
+    }
+
+    m_instructions.clear();
+    m_awaiting_acks = 0;
+
+    // now that the scene matches the placements, hidden views can be culled
+    for (Workspace_ptr workspace : workspaces)
+        mp_model->update_occlusion(workspace);
+}
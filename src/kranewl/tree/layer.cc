@@ -262,6 +262,8 @@ Layer::handle_destroy(struct wl_listener* listener, void*)
         layer->mp_layer_surface->output = nullptr;
     }
 
+    layer->mp_model->spatial_index().erase(layer);
+
     spdlog::info("Destroyed layer {}", layer->m_uid_formatted);
     delete layer;
 }
@@ -3,6 +3,7 @@
 #include <kranewl/model.hh>
 #include <kranewl/server.hh>
 #include <kranewl/tree/output.hh>
+#include <kranewl/tree/view.hh>
 #include <kranewl/util.hh>
 #include <kranewl/workspace.hh>
 
@@ -12,16 +13,20 @@
 #define namespace namespace_
 #define static
 extern "C" {
+#include <wlr/render/dmabuf.h>
+#include <wlr/types/wlr_buffer.h>
 #include <wlr/types/wlr_layer_shell_v1.h>
 #include <wlr/types/wlr_output_damage.h>
 #include <wlr/types/wlr_output_layout.h>
 #include <wlr/types/wlr_scene.h>
 #include <wlr/types/wlr_seat.h>
+#include <wlr/types/wlr_surface.h>
 }
 #undef static
 #undef namespace
 #undef class
 
+#include <algorithm>
 #include <vector>
 
 Output::Output(
@@ -40,6 +45,10 @@ Output::Output(
       m_modes({wlr_output->pending.mode}),
       mp_current_mode(wlr_output->pending.mode),
       m_dirty(true),
+      m_latency({}),
+      m_frame_scheduler(server, this),
+      m_frame_stats({}),
+      m_scanout_stats({}),
       m_cursor_focus_on_present(false),
       m_layer_map{
           { SCENE_LAYER_BACKGROUND, {} },
@@ -47,6 +56,15 @@ Output::Output(
           { SCENE_LAYER_TOP, {} },
           { SCENE_LAYER_OVERLAY, {} }
       },
+      mp_scanout_view(nullptr),
+      mp_scanout_blocker(nullptr),
+      m_adaptive_sync_policy(AdaptiveSyncPolicy::OptIn),
+      m_adaptive_sync_request(std::nullopt),
+      m_adaptive_sync_attempts(0),
+      m_throttled_views({}),
+      m_withheld_surfaces({}),
+      m_frame_time({}),
+      mp_frame_throttle_source(nullptr),
       mp_wlr_output(wlr_output),
       ml_frame({ .notify = Output::handle_frame }),
       ml_present({ .notify = Output::handle_present }),
@@ -62,7 +80,10 @@ Output::Output(
 }
 
 Output::~Output()
-{}
+{
+    if (mp_frame_throttle_source)
+        wl_event_source_remove(mp_frame_throttle_source);
+}
 
 void
 Output::handle_frame(struct wl_listener* listener, void*)
@@ -70,27 +91,31 @@ Output::handle_frame(struct wl_listener* listener, void*)
     TRACE();
 
     Output_ptr output = wl_container_of(listener, output, ml_frame);
-
-    // TODO: only rerender if no XDG views have an outstanding resize
-    //       and are visible on this monitor
-
-    struct wlr_scene_output* scene_output
-        = wlr_scene_get_scene_output(output->mp_server->mp_scene, output->mp_wlr_output);
-
-    if (!wlr_scene_output_commit(scene_output))
-        return;
-
-    struct timespec now;
-    clock_gettime(CLOCK_MONOTONIC, &now);
-    wlr_scene_output_send_frame_done(scene_output, &now);
+    output->m_frame_scheduler.schedule();
 }
 
 void
-Output::handle_present(struct wl_listener* listener, void*)
+Output::handle_present(struct wl_listener* listener, void* data)
 {
     TRACE();
 
     Output_ptr output = wl_container_of(listener, output, ml_present);
+    struct wlr_output_event_present* event
+        = reinterpret_cast<struct wlr_output_event_present*>(data);
+
+    uint64_t when = event->when
+        ? static_cast<uint64_t>(event->when->tv_sec) * 1'000'000'000
+            + static_cast<uint64_t>(event->when->tv_nsec)
+        : 0;
+
+    output->m_latency.present(
+        event->commit_seq,
+        event->presented && event->when,
+        when
+    );
+
+    if (event->presented && event->when)
+        output->m_frame_scheduler.record_present(when, event->refresh);
 
     if (output->m_cursor_focus_on_present && output == output->mp_model->mp_output) {
         if (output->context()->workspace()->focus_follows_cursor()) {
@@ -147,6 +172,241 @@ Output::handle_destroy(struct wl_listener*, void* data)
     output->mp_model->unregister_output(output);
 }
 
+void
+Output::render()
+{
+    TRACE();
+
+    struct wlr_scene_output* scene_output
+        = wlr_scene_get_scene_output(mp_server->mp_scene, mp_wlr_output);
+
+    struct timespec now;
+
+    // views in a pending transaction keep their previously applied placement
+    // until it commits, everything else on the output keeps being presented
+    if (mp_model->transaction_pending(this))
+        ++m_frame_stats.deferred;
+
+    // without scene damage or cursor movement there is nothing to present;
+    // no commit means no further frame events, so the output idles until
+    // new damage schedules a frame again
+    if (!pixman_region32_not_empty(&scene_output->damage->current)
+        && !mp_wlr_output->needs_frame)
+    {
+        ++m_frame_stats.skipped;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        send_frame_done(scene_output, now);
+        return;
+    }
+
+    // an undamaged output is not committed, in which case the sequence number
+    // stays put and pending input remains to be reflected by a later frame
+    uint32_t commit_seq = mp_wlr_output->commit_seq;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // a requested adaptive sync change rides along with the frame's commit
+    if (m_adaptive_sync_request)
+        wlr_output_enable_adaptive_sync(mp_wlr_output, *m_adaptive_sync_request);
+
+    bool committed = wlr_scene_output_commit(scene_output);
+
+    if (m_adaptive_sync_request)
+        settle_adaptive_sync();
+
+    if (!committed) {
+        ++m_frame_stats.failed;
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    if (mp_wlr_output->commit_seq != commit_seq) {
+        ++m_frame_stats.committed;
+
+        if (mp_scanout_view) {
+            if (scene_output->prev_scanout) {
+                ++m_scanout_stats.scanned_out;
+                mp_scanout_blocker = nullptr;
+            } else {
+                ++m_scanout_stats.composited;
+
+                char const* blocker = scanout_blocker();
+                if (blocker != mp_scanout_blocker && blocker)
+                    spdlog::debug("Direct scanout on {} not possible: {}",
+                        mp_wlr_output->name,
+                        blocker
+                    );
+
+                mp_scanout_blocker = blocker;
+            }
+        }
+
+        m_latency.commit(mp_wlr_output->commit_seq);
+        m_frame_scheduler.record_commit(
+            static_cast<uint64_t>(now.tv_sec - start.tv_sec) * 1'000'000'000
+                + now.tv_nsec - start.tv_nsec
+        );
+    }
+
+    send_frame_done(scene_output, now);
+}
+
+void
+Output::send_frame_done(struct wlr_scene_output* scene_output, struct timespec const& now)
+{
+    TRACE();
+
+    // without a workspace there are no views to throttle
+    if (!mp_context || !workspace()) {
+        m_throttled_views.clear();
+        wlr_scene_output_send_frame_done(scene_output, const_cast<struct timespec*>(&now));
+        return;
+    }
+
+    uint64_t now_ns = static_cast<uint64_t>(now.tv_sec) * 1'000'000'000
+        + static_cast<uint64_t>(now.tv_nsec);
+    uint64_t wait = 0;
+
+    m_throttled_views.clear();
+    m_withheld_surfaces.clear();
+
+    // capped views whose interval has not yet elapsed keep their callbacks
+    // pending, they are delivered by a later frame or the throttle timer
+    for (View_ptr view : *workspace())
+        if (throttle_view(view, now_ns, wait)) {
+            m_throttled_views.push_back(view);
+            wlr_scene_node_for_each_surface(view->mp_scene, Output::withhold_surface, this);
+        }
+
+    if (m_withheld_surfaces.empty())
+        wlr_scene_output_send_frame_done(scene_output, const_cast<struct timespec*>(&now));
+    else {
+        m_frame_time = now;
+        wlr_scene_output_for_each_surface(scene_output, Output::send_surface_frame_done, this);
+    }
+
+    arm_frame_throttle(wait);
+}
+
+bool
+Output::throttle_view(View_ptr view, uint64_t now_ns, uint64_t& wait) const
+{
+    unsigned frame_rate = mp_model->frame_rate_cap(view);
+    if (!frame_rate || !view->mapped() || view->occluded())
+        return false;
+
+    uint64_t interval = 1'000'000'000 / frame_rate;
+    uint64_t elapsed = now_ns - view->m_last_frame_done;
+    uint64_t tolerance = std::chrono::nanoseconds(FRAME_TOLERANCE).count();
+
+    if (elapsed + tolerance >= interval) {
+        view->m_last_frame_done = now_ns;
+        return false;
+    }
+
+    if (!wait || interval - elapsed < wait)
+        wait = interval - elapsed;
+
+    return true;
+}
+
+void
+Output::arm_frame_throttle(uint64_t wait)
+{
+    if (!wait)
+        return;
+
+    if (!mp_frame_throttle_source)
+        mp_frame_throttle_source = wl_event_loop_add_timer(
+            mp_server->mp_event_loop,
+            Output::handle_frame_throttle,
+            this
+        );
+
+    int delay = static_cast<int>((wait + 999'999) / 1'000'000);
+    if (!mp_frame_throttle_source
+        || wl_event_source_timer_update(mp_frame_throttle_source, delay) < 0)
+    {
+        spdlog::error("Could not arm frame throttle timer");
+    }
+}
+
+void
+Output::withhold_surface(struct wlr_surface* surface, int, int, void* data)
+{
+    Output_ptr output = reinterpret_cast<Output_ptr>(data);
+    output->m_withheld_surfaces.push_back(surface);
+}
+
+void
+Output::send_surface_frame_done(struct wlr_surface* surface, int, int, void* data)
+{
+    Output_ptr output = reinterpret_cast<Output_ptr>(data);
+
+    if (std::find(
+        output->m_withheld_surfaces.begin(),
+        output->m_withheld_surfaces.end(),
+        surface
+    ) == output->m_withheld_surfaces.end())
+        wlr_surface_send_frame_done(surface, &output->m_frame_time);
+}
+
+void
+Output::release_surface_frame_done(struct wlr_surface* surface, int, int, void* data)
+{
+    Output_ptr output = reinterpret_cast<Output_ptr>(data);
+    wlr_surface_send_frame_done(surface, &output->m_frame_time);
+}
+
+int
+Output::handle_frame_throttle(void* data)
+{
+    TRACE();
+
+    Output_ptr output = reinterpret_cast<Output_ptr>(data);
+
+    if (!output->mp_context || !output->workspace()) {
+        output->m_throttled_views.clear();
+        return 0;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    uint64_t now_ns = static_cast<uint64_t>(now.tv_sec) * 1'000'000'000
+        + static_cast<uint64_t>(now.tv_nsec);
+    uint64_t wait = 0;
+
+    std::vector<View_ptr> throttled_views = std::move(output->m_throttled_views);
+    output->m_throttled_views.clear();
+    output->m_frame_time = now;
+
+    // only the views withheld by the last frame are considered here, the
+    // others already received their callbacks and wait for the next vblank;
+    // views that left the workspace in the meantime are never dereferenced
+    for (View_ptr view : *output->workspace()) {
+        if (std::find(throttled_views.begin(), throttled_views.end(), view)
+            == throttled_views.end())
+        {
+            continue;
+        }
+
+        if (output->throttle_view(view, now_ns, wait))
+            output->m_throttled_views.push_back(view);
+        else
+            wlr_scene_node_for_each_surface(
+                view->mp_scene,
+                Output::release_surface_frame_done,
+                output
+            );
+    }
+
+    output->arm_frame_throttle(wait);
+    return 0;
+}
+
 void
 Output::set_context(Context_ptr context)
 {
@@ -241,6 +501,7 @@ Output::add_layer(Layer_ptr layer)
 {
     TRACE();
     m_layer_map[layer->m_scene_layer].push_back(layer);
+    wlr_scene_node_set_enabled(layer->mp_scene, !hides_layer(layer->m_scene_layer));
 }
 
 void
@@ -258,6 +519,176 @@ Output::relayer_layer(Layer_ptr layer, SceneLayer old_layer, SceneLayer new_laye
     Util::erase_remove(m_layer_map.at(old_layer), layer);
     m_layer_map[new_layer].push_back(layer);
     layer->m_scene_layer = new_layer;
+    mp_model->spatial_index().relayer(layer, new_layer);
+    wlr_scene_node_set_enabled(layer->mp_scene, !hides_layer(new_layer));
+}
+
+bool
+Output::hides_layer(SceneLayer layer) const
+{
+    // overlay surfaces (e.g., notifications and lock screens) stay on top
+    return mp_scanout_view && layer != SCENE_LAYER_OVERLAY;
+}
+
+void
+Output::set_scanout_view(View_ptr view)
+{
+    TRACE();
+
+    if (view == mp_scanout_view)
+        return;
+
+    if (mp_scanout_view)
+        mp_scanout_view->set_decoration_hidden(false);
+
+    mp_scanout_view = view;
+    mp_scanout_blocker = nullptr;
+
+    if (mp_scanout_view) {
+        mp_scanout_view->set_decoration_hidden(true);
+        spdlog::debug("Output {} dedicated to fullscreen view {}",
+            mp_wlr_output->name,
+            mp_scanout_view->uid_formatted()
+        );
+    }
+
+    for (auto& [scene_layer, layers] : m_layer_map)
+        for (Layer_ptr layer : layers)
+            wlr_scene_node_set_enabled(layer->mp_scene, !hides_layer(scene_layer));
+
+    update_adaptive_sync();
+}
+
+void
+Output::set_adaptive_sync_policy(AdaptiveSyncPolicy policy)
+{
+    TRACE();
+
+    m_adaptive_sync_policy = policy;
+    update_adaptive_sync();
+}
+
+void
+Output::update_adaptive_sync()
+{
+    TRACE();
+
+    if (!enabled())
+        return;
+
+    // a focused fullscreen view may opt out of (Fullscreen) or has to opt in
+    // to (OptIn) a variable refresh rate through its rules
+    bool adaptive_sync = false;
+    switch (m_adaptive_sync_policy) {
+    case AdaptiveSyncPolicy::Never:  adaptive_sync = false; break;
+    case AdaptiveSyncPolicy::Always: adaptive_sync = true;  break;
+    case AdaptiveSyncPolicy::Fullscreen:
+        adaptive_sync = mp_scanout_view && mp_scanout_view->adaptive_sync().value_or(true);
+        break;
+    case AdaptiveSyncPolicy::OptIn:
+        adaptive_sync = mp_scanout_view && mp_scanout_view->adaptive_sync().value_or(false);
+        break;
+    }
+
+    bool enabled = mp_wlr_output->adaptive_sync_status == WLR_OUTPUT_ADAPTIVE_SYNC_ENABLED;
+    if (adaptive_sync == enabled) {
+        m_adaptive_sync_request = std::nullopt;
+        return;
+    }
+
+    if (m_adaptive_sync_request == adaptive_sync)
+        return;
+
+    // committing here would fail while a page flip is pending, so the change
+    // is left for the next frame to carry instead
+    m_adaptive_sync_request = adaptive_sync;
+    m_adaptive_sync_attempts = 0;
+    request_adaptive_sync_frame();
+}
+
+void
+Output::request_adaptive_sync_frame()
+{
+    TRACE();
+
+    struct wlr_scene_output* scene_output
+        = wlr_scene_get_scene_output(mp_server->mp_scene, mp_wlr_output);
+
+    // an undamaged output would not commit at all
+    if (scene_output)
+        wlr_output_damage_add_whole(scene_output->damage);
+
+    wlr_output_schedule_frame(mp_wlr_output);
+}
+
+void
+Output::settle_adaptive_sync()
+{
+    TRACE();
+
+    bool adaptive_sync = *m_adaptive_sync_request;
+    bool enabled = mp_wlr_output->adaptive_sync_status == WLR_OUTPUT_ADAPTIVE_SYNC_ENABLED;
+
+    if (adaptive_sync == enabled) {
+        m_adaptive_sync_request = std::nullopt;
+
+        spdlog::info("Adaptive sync {} on output {}",
+            adaptive_sync ? "enabled" : "disabled",
+            mp_wlr_output->name
+        );
+
+        return;
+    }
+
+    // outputs that do not support a variable refresh rate reject every
+    // commit carrying it, so give up before it keeps frames from presenting
+    if (++m_adaptive_sync_attempts >= ADAPTIVE_SYNC_ATTEMPTS) {
+        m_adaptive_sync_request = std::nullopt;
+
+        spdlog::warn("Could not {} adaptive sync on output {}",
+            adaptive_sync ? "enable" : "disable",
+            mp_wlr_output->name
+        );
+
+        return;
+    }
+
+    request_adaptive_sync_frame();
+}
+
+char const*
+Output::scanout_blocker() const
+{
+    if (!mp_scanout_view || !mp_scanout_view->mapped())
+        return "no fullscreen view";
+
+    struct wlr_surface* surface = mp_scanout_view->mp_wlr_surface;
+    if (!surface || !wlr_surface_has_buffer(surface))
+        return "view has no buffer attached";
+
+    struct wlr_dmabuf_attributes attributes;
+    if (!wlr_buffer_get_dmabuf(&surface->buffer->base, &attributes))
+        return "client buffer is not a dmabuf";
+
+    if (surface->current.buffer_width != mp_wlr_output->width
+        || surface->current.buffer_height != mp_wlr_output->height)
+    {
+        return "buffer size does not match the output mode";
+    }
+
+    if (surface->current.transform != mp_wlr_output->transform)
+        return "buffer transform does not match the output";
+
+    if (!wl_list_empty(&surface->current.subsurfaces_above)
+        || !wl_list_empty(&surface->current.subsurfaces_below))
+    {
+        return "view has subsurfaces";
+    }
+
+    if (mp_scanout_view->active_region() != m_full_region)
+        return "view does not cover the output";
+
+    return "buffer rejected by the output (format, modifier or other planes)";
 }
 
 void
@@ -468,6 +899,13 @@ arrange_layer(
 
         wlr_scene_node_set_position(layer->mp_scene, region.pos.x, region.pos.y);
         wlr_layer_surface_v1_configure(layer_surface, region.dim.w, region.dim.h);
+
+        output->mp_model->spatial_index().insert(
+            layer,
+            layer->mp_scene,
+            layer->m_scene_layer,
+            region
+        );
     }
 }
 
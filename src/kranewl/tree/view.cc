@@ -1,11 +1,13 @@
 #include <trace.hh>
 
+#include <kranewl/context.hh>
 #include <kranewl/model.hh>
 #include <kranewl/scene-layer.hh>
 #include <kranewl/server.hh>
 #include <kranewl/tree/output.hh>
 #include <kranewl/tree/view.hh>
 #include <kranewl/tree/xdg-view.hh>
+#include <kranewl/workspace.hh>
 
 // https://github.com/swaywm/wlroots/issues/682
 #include <pthread.h>
@@ -41,6 +43,11 @@ View::View(
       mp_wlr_surface(wlr_surface),
       m_alpha(1.f),
       m_resize(0),
+      m_last_frame_done(0),
+      m_configured_region(std::nullopt),
+      m_configured_extents({0, 0, 0, 0}),
+      m_paced_configure(std::nullopt),
+      m_configure_sent(std::chrono::steady_clock::now()),
       m_tile_decoration(FREE_DECORATION),
       m_free_decoration(FREE_DECORATION),
       m_active_decoration(FREE_DECORATION),
@@ -67,6 +74,13 @@ View::View(
       m_iconifyable(true),
       m_iconified(false),
       m_disowned(false),
+      m_occluded(false),
+      m_opaque(false),
+      m_decoration_hidden(false),
+      m_indicated_as_next(false),
+      m_indicated_as_prev(false),
+      m_adaptive_sync(std::nullopt),
+      m_frame_rate(std::nullopt),
       m_scene_layer(SCENE_LAYER_NONE),
       m_last_focused(std::chrono::steady_clock::now()),
       m_last_touched(std::chrono::steady_clock::now()),
@@ -95,6 +109,11 @@ View::View(
       mp_wlr_surface(wlr_surface),
       m_alpha(1.f),
       m_resize(0),
+      m_last_frame_done(0),
+      m_configured_region(std::nullopt),
+      m_configured_extents({0, 0, 0, 0}),
+      m_paced_configure(std::nullopt),
+      m_configure_sent(std::chrono::steady_clock::now()),
       m_tile_decoration(FREE_DECORATION),
       m_free_decoration(FREE_DECORATION),
       m_active_decoration(FREE_DECORATION),
@@ -119,6 +138,13 @@ View::View(
       m_iconifyable(true),
       m_iconified(false),
       m_disowned(false),
+      m_occluded(false),
+      m_opaque(false),
+      m_decoration_hidden(false),
+      m_indicated_as_next(false),
+      m_indicated_as_prev(false),
+      m_adaptive_sync(std::nullopt),
+      m_frame_rate(std::nullopt),
       m_scene_layer(SCENE_LAYER_NONE),
       m_last_focused(std::chrono::steady_clock::now()),
       m_last_touched(std::chrono::steady_clock::now()),
@@ -279,6 +305,14 @@ View::belongs_to_active_track() const
     return m_scene_layer == mp_workspace->track_layer();
 }
 
+bool
+View::configured_as(Region const& region, Extents const& extents) const
+{
+    return m_configured_region
+        && *m_configured_region == region
+        && m_configured_extents == extents;
+}
+
 std::chrono::time_point<std::chrono::steady_clock>
 View::last_focused() const
 {
@@ -297,11 +331,168 @@ View::managed_since() const
     return m_managed_since;
 }
 
+void
+View::configure(Region const& region, Extents const& extents, bool interactive)
+{
+    TRACE();
+
+    // interactive configures are paced by the client: while one is in flight,
+    // only the latest is retained, and the frame already follows the pointer
+    // around the last committed buffer
+    if (interactive && m_resize
+        && std::chrono::steady_clock::now() - m_configure_sent < PACING_TIMEOUT)
+    {
+        m_paced_configure = std::pair{region, extents};
+        apply_configure(region, extents);
+        return;
+    }
+
+    m_paced_configure = std::nullopt;
+
+    send_configure(region, extents);
+    apply_configure(region, extents);
+}
+
+void
+View::flush_paced_configure()
+{
+    TRACE();
+
+    if (!m_paced_configure)
+        return;
+
+    auto [region, extents] = *m_paced_configure;
+    m_paced_configure = std::nullopt;
+
+    send_configure(region, extents);
+    apply_configure(region, extents);
+}
+
+void
+View::schedule_frame()
+{
+    TRACE();
+
+    // a commit that only requests a frame callback does not damage the scene,
+    // so the (otherwise idle) output must be woken up to deliver it
+    if (!m_mapped || !mp_context
+        || wl_list_empty(&mp_wlr_surface->current.frame_callback_list))
+    {
+        return;
+    }
+
+    Output_ptr output = mp_context->output();
+    if (output && output->enabled())
+        wlr_output_schedule_frame(output->mp_wlr_output);
+}
+
+void
+View::set_occluded(bool occluded)
+{
+    TRACE();
+
+    if (occluded == m_occluded)
+        return;
+
+    // a disabled scene node is neither rendered nor sent frame callbacks
+    m_occluded = occluded;
+    if (m_mapped)
+        wlr_scene_node_set_enabled(mp_scene, !m_occluded);
+}
+
+void
+View::set_decoration_hidden(bool hidden)
+{
+    TRACE();
+
+    if (hidden == m_decoration_hidden)
+        return;
+
+    m_decoration_hidden = hidden;
+
+    for (std::size_t i = 0; i < 4; ++i)
+        wlr_scene_node_set_enabled(&m_protrusions[i]->node, !hidden);
+
+    for (std::size_t i = 0; i < 2; ++i) {
+        wlr_scene_node_set_enabled(&m_next_indicator[i]->node, !hidden && m_indicated_as_next);
+        wlr_scene_node_set_enabled(&m_prev_indicator[i]->node, !hidden && m_indicated_as_prev);
+    }
+}
+
+bool
+View::surface_opaque() const
+{
+    if (!m_mapped || !mp_wlr_surface)
+        return false;
+
+    Extents const& extents = m_active_decoration.extents();
+    int width = m_active_region.dim.w - extents.left - extents.right;
+    int height = m_active_region.dim.h - extents.top - extents.bottom;
+
+    // the surface has to fill its frame entirely and declare all of it opaque
+    if (mp_wlr_surface->current.width < width || mp_wlr_surface->current.height < height)
+        return false;
+
+    pixman_box32_t box = {
+        .x1 = 0,
+        .y1 = 0,
+        .x2 = width,
+        .y2 = height
+    };
+
+    return pixman_region32_contains_rectangle(
+        &mp_wlr_surface->opaque_region,
+        &box
+    ) == PIXMAN_REGION_IN;
+}
+
+void
+View::update_opaque()
+{
+    if (!m_mapped || !mp_workspace)
+        return;
+
+    // only a change in opacity can alter what this view hides from view
+    bool opaque = surface_opaque();
+    if (opaque == m_opaque)
+        return;
+
+    m_opaque = opaque;
+    mp_model->update_occlusion(mp_workspace);
+}
+
+void
+View::apply_configure(Region const& region, Extents const& extents)
+{
+    TRACE();
+
+    wlr_scene_node_set_position(mp_scene, region.pos.x, region.pos.y);
+    wlr_scene_node_set_position(mp_scene_surface, extents.left, extents.top);
+    wlr_scene_rect_set_size(m_protrusions[0], region.dim.w, extents.top);
+    wlr_scene_rect_set_size(m_protrusions[1], region.dim.w, extents.bottom);
+    wlr_scene_rect_set_size(m_protrusions[2], extents.left, region.dim.h - extents.top - extents.bottom);
+    wlr_scene_rect_set_size(m_protrusions[3], extents.right, region.dim.h - extents.top - extents.bottom);
+    wlr_scene_node_set_position(&m_protrusions[0]->node, 0, 0);
+    wlr_scene_node_set_position(&m_protrusions[1]->node, 0, region.dim.h - extents.bottom);
+    wlr_scene_node_set_position(&m_protrusions[2]->node, 0, extents.top);
+    wlr_scene_node_set_position(&m_protrusions[3]->node, region.dim.w - extents.right, extents.top);
+    wlr_scene_rect_set_size(m_next_indicator[0], CYCLE_INDICATOR_SIZE, extents.top);
+    wlr_scene_rect_set_size(m_next_indicator[1], extents.left, CYCLE_INDICATOR_SIZE);
+    wlr_scene_rect_set_size(m_prev_indicator[0], CYCLE_INDICATOR_SIZE, extents.top);
+    wlr_scene_rect_set_size(m_prev_indicator[1], extents.right, CYCLE_INDICATOR_SIZE);
+    wlr_scene_node_set_position(&m_next_indicator[0]->node, 0, 0);
+    wlr_scene_node_set_position(&m_next_indicator[1]->node, 0, 0);
+    wlr_scene_node_set_position(&m_prev_indicator[0]->node, region.dim.w - CYCLE_INDICATOR_SIZE, 0);
+    wlr_scene_node_set_position(&m_prev_indicator[1]->node, region.dim.w - extents.right, 0);
+
+    mp_model->spatial_index().insert(this, mp_scene, m_scene_layer, region);
+}
+
 void
 View::map()
 {
     if (!m_mapped) {
-        wlr_scene_node_set_enabled(mp_scene, true);
+        wlr_scene_node_set_enabled(mp_scene, !m_occluded);
         m_mapped = true;
     }
 }
@@ -313,6 +504,7 @@ View::unmap()
         focus(Toggle::Off);
         wlr_scene_node_set_enabled(mp_scene, false);
         m_mapped = false;
+        m_occluded = false;
     }
 }
 
@@ -371,10 +563,23 @@ View::relayer(SceneLayer layer)
         return;
 
     m_scene_layer = layer;
-    wlr_scene_node_reparent(
-        mp_scene,
-        mp_server->m_scene_layers[layer]
-    );
+    mp_model->spatial_index().relayer(this, layer);
+    reparent();
+}
+
+void
+View::reparent()
+{
+    struct wlr_scene_node* scene_layer;
+
+    if (m_sticky && mp_context)
+        scene_layer = mp_context->scene_layer(m_scene_layer);
+    else if (mp_workspace)
+        scene_layer = mp_workspace->scene_layer(m_scene_layer);
+    else
+        scene_layer = mp_server->m_scene_layers[m_scene_layer];
+
+    wlr_scene_node_reparent(mp_scene, scene_layer);
 }
 
 void
@@ -534,13 +739,15 @@ View::set_tile_decoration(Decoration const& decoration)
 void
 View::indicate_as_next()
 {
-    wlr_scene_node_set_enabled(&m_next_indicator[0]->node, true);
-    wlr_scene_node_set_enabled(&m_next_indicator[1]->node, true);
+    m_indicated_as_next = true;
+    wlr_scene_node_set_enabled(&m_next_indicator[0]->node, !m_decoration_hidden);
+    wlr_scene_node_set_enabled(&m_next_indicator[1]->node, !m_decoration_hidden);
 }
 
 void
 View::unindicate_as_next()
 {
+    m_indicated_as_next = false;
     wlr_scene_node_set_enabled(&m_next_indicator[0]->node, false);
     wlr_scene_node_set_enabled(&m_next_indicator[1]->node, false);
 }
@@ -548,13 +755,15 @@ View::unindicate_as_next()
 void
 View::indicate_as_prev()
 {
-    wlr_scene_node_set_enabled(&m_prev_indicator[0]->node, true);
-    wlr_scene_node_set_enabled(&m_prev_indicator[1]->node, true);
+    m_indicated_as_prev = true;
+    wlr_scene_node_set_enabled(&m_prev_indicator[0]->node, !m_decoration_hidden);
+    wlr_scene_node_set_enabled(&m_prev_indicator[1]->node, !m_decoration_hidden);
 }
 
 void
 View::unindicate_as_prev()
 {
+    m_indicated_as_prev = false;
     wlr_scene_node_set_enabled(&m_prev_indicator[0]->node, false);
     wlr_scene_node_set_enabled(&m_prev_indicator[1]->node, false);
 }
@@ -1,6 +1,7 @@
 #include <trace.hh>
 
 #include <kranewl/context.hh>
+#include <kranewl/ipc-server.hh>
 #include <kranewl/model.hh>
 #include <kranewl/scene-layer.hh>
 #include <kranewl/server.hh>
@@ -207,35 +208,26 @@ XDGView::effectuate_fullscreen(bool fullscreen)
     }
 }
 
-void
-XDGView::configure(Region const& region, Extents const& extents, bool interactive)
+bool
+XDGView::send_configure(Region const& region, Extents const& extents)
 {
     TRACE();
 
-    wlr_scene_node_set_position(mp_scene, region.pos.x, region.pos.y);
-    wlr_scene_node_set_position(mp_scene_surface, extents.left, extents.top);
-    wlr_scene_rect_set_size(m_protrusions[0], region.dim.w, extents.top);
-    wlr_scene_rect_set_size(m_protrusions[1], region.dim.w, extents.bottom);
-    wlr_scene_rect_set_size(m_protrusions[2], extents.left, region.dim.h - extents.top - extents.bottom);
-    wlr_scene_rect_set_size(m_protrusions[3], extents.right, region.dim.h - extents.top - extents.bottom);
-    wlr_scene_node_set_position(&m_protrusions[0]->node, 0, 0);
-    wlr_scene_node_set_position(&m_protrusions[1]->node, 0, region.dim.h - extents.bottom);
-    wlr_scene_node_set_position(&m_protrusions[2]->node, 0, extents.top);
-    wlr_scene_node_set_position(&m_protrusions[3]->node, region.dim.w - extents.right, extents.top);
-    wlr_scene_rect_set_size(m_next_indicator[0], CYCLE_INDICATOR_SIZE, extents.top);
-    wlr_scene_rect_set_size(m_next_indicator[1], extents.left, CYCLE_INDICATOR_SIZE);
-    wlr_scene_rect_set_size(m_prev_indicator[0], CYCLE_INDICATOR_SIZE, extents.top);
-    wlr_scene_rect_set_size(m_prev_indicator[1], extents.right, CYCLE_INDICATOR_SIZE);
-    wlr_scene_node_set_position(&m_next_indicator[0]->node, 0, 0);
-    wlr_scene_node_set_position(&m_next_indicator[1]->node, 0, 0);
-    wlr_scene_node_set_position(&m_prev_indicator[0]->node, region.dim.w - CYCLE_INDICATOR_SIZE, 0);
-    wlr_scene_node_set_position(&m_prev_indicator[1]->node, region.dim.w - extents.right, 0);
-
-	m_resize = wlr_xdg_toplevel_set_size(
-        mp_wlr_xdg_surface,
-        region.dim.w - extents.left - extents.right,
-        region.dim.h - extents.top - extents.bottom
-    );
+    m_configured_region = region;
+    m_configured_extents = extents;
+
+    Dim dim = Dim{
+        .w = region.dim.w - extents.left - extents.right,
+        .h = region.dim.h - extents.top - extents.bottom
+    };
+
+    struct wlr_xdg_toplevel_state* state = &mp_wlr_xdg_toplevel->current;
+    if (!m_resize && state->width == dim.w && state->height == dim.h)
+        return false;
+
+    m_resize = wlr_xdg_toplevel_set_size(mp_wlr_xdg_surface, dim.w, dim.h);
+    m_configure_sent = std::chrono::steady_clock::now();
+    return true;
 }
 
 void
@@ -252,15 +244,26 @@ XDGView::close_popups()
 
 }
 
+bool
+XDGView::has_popups() const
+{
+    return !wl_list_empty(&mp_wlr_xdg_surface->popups);
+}
+
 void
 XDGView::handle_commit(struct wl_listener* listener, void* data)
 {
     TRACE();
 
     XDGView_ptr view = wl_container_of(listener, view, ml_commit);
+    view->schedule_frame();
+    view->update_opaque();
 
-	if (view->m_resize && view->m_resize <= view->mp_wlr_xdg_surface->current.configure_serial)
-		view->m_resize = 0;
+    if (view->m_resize && view->m_resize <= view->mp_wlr_xdg_surface->current.configure_serial) {
+        view->m_resize = 0;
+        view->mp_model->acknowledge_configure(view);
+        view->flush_paced_configure();
+    }
 }
 
 void
@@ -324,6 +327,13 @@ XDGView::handle_set_title(struct wl_listener* listener, void* data)
         ? view->mp_wlr_xdg_toplevel->title : "");
     view->set_title_formatted(view->title());
     view->format_uid();
+    view->mp_model->reindex_view(view);
+
+    if (view->mp_server->mp_ipc_server)
+        view->mp_server->mp_ipc_server->emit_title(view);
+
+    if (view->focused())
+        view->mp_model->publish_snapshot();
 }
 
 void
@@ -332,8 +342,16 @@ XDGView::handle_set_app_id(struct wl_listener* listener, void* data)
     TRACE();
 
     XDGView_ptr view = wl_container_of(listener, view, ml_set_app_id);
-    view->set_app_id(view->mp_wlr_xdg_toplevel->app_id);
+    view->set_app_id(view->mp_wlr_xdg_toplevel->app_id
+        ? view->mp_wlr_xdg_toplevel->app_id : "");
     view->format_uid();
+    view->mp_model->reindex_view(view);
+
+    if (view->mp_server->mp_ipc_server)
+        view->mp_server->mp_ipc_server->emit_app_id(view);
+
+    if (view->focused())
+        view->mp_model->publish_snapshot();
 }
 
 void
@@ -508,6 +526,7 @@ XDGView::handle_unmap(struct wl_listener* listener, void* data)
 
     wlr_scene_node_destroy(view->mp_scene);
 	view->mp_wlr_surface = nullptr;
+    view->m_configured_region = std::nullopt;
     view->set_managed(false);
 
     if (view->mp_model->mp_workspace)
@@ -2,6 +2,7 @@
 #include <trace.hh>
 
 #include <kranewl/context.hh>
+#include <kranewl/ipc-server.hh>
 #include <kranewl/model.hh>
 #include <kranewl/scene-layer.hh>
 #include <kranewl/server.hh>
@@ -26,6 +27,8 @@ extern "C" {
 #undef namespace
 #undef class
 
+#include <algorithm>
+
 XWaylandView::XWaylandView(
     struct wlr_xwayland_surface* wlr_xwayland_surface,
     Server_ptr server,
@@ -45,6 +48,7 @@ XWaylandView::XWaylandView(
       mp_wlr_xwayland_surface(wlr_xwayland_surface),
       ml_map({ .notify = XWaylandView::handle_map }),
       ml_unmap({ .notify = XWaylandView::handle_unmap }),
+      ml_commit({ .notify = XWaylandView::handle_commit }),
       ml_request_activate({ .notify = XWaylandView::handle_request_activate }),
       ml_request_configure({ .notify = XWaylandView::handle_request_configure }),
       ml_request_fullscreen({ .notify = XWaylandView::handle_request_fullscreen }),
@@ -249,39 +253,73 @@ XWaylandView::effectuate_fullscreen(bool fullscreen)
     }
 }
 
-void
-XWaylandView::configure(Region const& region, Extents const& extents, bool interactive)
-{
-    TRACE();
-
-    wlr_scene_node_set_position(mp_scene, region.pos.x, region.pos.y);
-    wlr_scene_node_set_position(mp_scene_surface, extents.left, extents.top);
-    wlr_scene_rect_set_size(m_protrusions[0], region.dim.w, extents.top);
-    wlr_scene_rect_set_size(m_protrusions[1], region.dim.w, extents.bottom);
-    wlr_scene_rect_set_size(m_protrusions[2], extents.left, region.dim.h - extents.top - extents.bottom);
-    wlr_scene_rect_set_size(m_protrusions[3], extents.right, region.dim.h - extents.top - extents.bottom);
-    wlr_scene_node_set_position(&m_protrusions[0]->node, 0, 0);
-    wlr_scene_node_set_position(&m_protrusions[1]->node, 0, region.dim.h - extents.bottom);
-    wlr_scene_node_set_position(&m_protrusions[2]->node, 0, extents.top);
-    wlr_scene_node_set_position(&m_protrusions[3]->node, region.dim.w - extents.right, extents.top);
-    wlr_scene_rect_set_size(m_next_indicator[0], CYCLE_INDICATOR_SIZE, extents.top);
-    wlr_scene_rect_set_size(m_next_indicator[1], extents.left, CYCLE_INDICATOR_SIZE);
-    wlr_scene_rect_set_size(m_prev_indicator[0], CYCLE_INDICATOR_SIZE, extents.top);
-    wlr_scene_rect_set_size(m_prev_indicator[1], extents.right, CYCLE_INDICATOR_SIZE);
-    wlr_scene_node_set_position(&m_next_indicator[0]->node, 0, 0);
-    wlr_scene_node_set_position(&m_next_indicator[1]->node, 0, 0);
-    wlr_scene_node_set_position(&m_prev_indicator[0]->node, region.dim.w - CYCLE_INDICATOR_SIZE, 0);
-    wlr_scene_node_set_position(&m_prev_indicator[1]->node, region.dim.w - extents.right, 0);
+// the size an X11 client settles on, given its WM_NORMAL_HINTS
+static Dim
+hinted_dim(struct wlr_xwayland_surface* xwayland_surface, Dim dim)
+{
+    struct wlr_xwayland_surface_size_hints* size_hints = xwayland_surface->size_hints;
+    if (!size_hints)
+        return dim;
+
+    if (size_hints->max_width > 0)
+        dim.w = std::min(dim.w, size_hints->max_width);
+    if (size_hints->max_height > 0)
+        dim.h = std::min(dim.h, size_hints->max_height);
+    if (size_hints->min_width > 0)
+        dim.w = std::max(dim.w, size_hints->min_width);
+    if (size_hints->min_height > 0)
+        dim.h = std::max(dim.h, size_hints->min_height);
+
+    // ICCCM: the base size defaults to the minimum size
+    int base_width = size_hints->base_width > 0
+        ? size_hints->base_width
+        : std::max(size_hints->min_width, 0);
+    int base_height = size_hints->base_height > 0
+        ? size_hints->base_height
+        : std::max(size_hints->min_height, 0);
+
+    if (size_hints->width_inc > 1 && dim.w > base_width)
+        dim.w -= (dim.w - base_width) % size_hints->width_inc;
+    if (size_hints->height_inc > 1 && dim.h > base_height)
+        dim.h -= (dim.h - base_height) % size_hints->height_inc;
+
+    return dim;
+}
+
+bool
+XWaylandView::send_configure(Region const& region, Extents const& extents)
+{
+    TRACE();
+
+    m_configured_region = region;
+    m_configured_extents = extents;
+
+    Dim dim = Dim{
+        .w = region.dim.w - extents.left - extents.right,
+        .h = region.dim.h - extents.top - extents.bottom
+    };
 
     wlr_xwayland_surface_configure(
         mp_wlr_xwayland_surface,
         region.pos.x,
         region.pos.y,
-        region.dim.w - extents.left - extents.right,
-        region.dim.h - extents.top - extents.bottom
+        dim.w,
+        dim.h
     );
 
-    m_resize = 0;
+    Dim hinted = hinted_dim(mp_wlr_xwayland_surface, dim);
+
+    if (!mp_wlr_surface
+        || (mp_wlr_surface->current.width == hinted.w
+            && mp_wlr_surface->current.height == hinted.h))
+    {
+        m_resize = 0;
+        return false;
+    }
+
+    m_resize = 1;
+    m_configure_sent = std::chrono::steady_clock::now();
+    return true;
 }
 
 void
@@ -417,6 +455,8 @@ XWaylandView::handle_map(struct wl_listener* listener, void* data)
     view->set_free_region(region);
     view->set_tile_region(region);
 
+    wl_signal_add(&view->mp_wlr_surface->events.commit, &view->ml_commit);
+
     view->set_mapped(true);
     view->render_decoration();
     model->register_view(view, workspace);
@@ -429,17 +469,50 @@ XWaylandView::handle_unmap(struct wl_listener* listener, void*)
 
     XWaylandView_ptr view = wl_container_of(listener, view, ml_unmap);
 
+    wl_list_remove(&view->ml_commit.link);
+
     view->activate(Toggle::Off);
     view->mp_model->unregister_view(view);
 
     wlr_scene_node_destroy(view->mp_scene);
     view->mp_wlr_surface = nullptr;
+    view->m_configured_region = std::nullopt;
     view->set_managed(false);
 
     if (view->mp_model->mp_workspace)
         view->mp_model->apply_layout(view->mp_workspace);
 }
 
+void
+XWaylandView::handle_commit(struct wl_listener* listener, void*)
+{
+    TRACE();
+
+    XWaylandView_ptr view = wl_container_of(listener, view, ml_commit);
+    view->schedule_frame();
+    view->update_opaque();
+
+    if (!view->m_resize || !view->m_configured_region)
+        return;
+
+    Region const& region = *view->m_configured_region;
+    Extents const& extents = view->m_configured_extents;
+
+    // clients with size increments or bounds never commit the exact size
+    Dim hinted = hinted_dim(view->mp_wlr_xwayland_surface, Dim{
+        .w = region.dim.w - extents.left - extents.right,
+        .h = region.dim.h - extents.top - extents.bottom
+    });
+
+    if (view->mp_wlr_surface->current.width == hinted.w
+        && view->mp_wlr_surface->current.height == hinted.h)
+    {
+        view->m_resize = 0;
+        view->mp_model->acknowledge_configure(view);
+        view->flush_paced_configure();
+    }
+}
+
 void
 XWaylandView::handle_request_activate(struct wl_listener* listener, void*)
 {
@@ -604,6 +677,13 @@ XWaylandView::handle_set_title(struct wl_listener* listener, void*)
         ? view->mp_wlr_xwayland_surface->title : "N/a");
     view->set_title_formatted(view->title()); // TODO: format title
     view->format_uid();
+    view->mp_model->reindex_view(view);
+
+    if (view->mp_server->mp_ipc_server)
+        view->mp_server->mp_ipc_server->emit_title(view);
+
+    if (view->focused())
+        view->mp_model->publish_snapshot();
 }
 
 void
@@ -614,7 +694,15 @@ XWaylandView::handle_set_class(struct wl_listener* listener, void*)
     XWaylandView_ptr view = wl_container_of(listener, view, ml_set_class);
     view->set_class(view->mp_wlr_xwayland_surface->class_
         ? view->mp_wlr_xwayland_surface->class_ : "N/a");
+    view->set_app_id(view->m_class);
     view->format_uid();
+    view->mp_model->reindex_view(view);
+
+    if (view->mp_server->mp_ipc_server)
+        view->mp_server->mp_ipc_server->emit_app_id(view);
+
+    if (view->focused())
+        view->mp_model->publish_snapshot();
 }
 
 void
@@ -775,6 +863,13 @@ XWaylandUnmanaged::handle_map(struct wl_listener* listener, void* data)
         unmanaged->m_region.pos.y
     );
 
+    unmanaged->mp_model->spatial_index().insert(
+        unmanaged,
+        unmanaged->mp_scene,
+        SCENE_LAYER_FREE,
+        unmanaged->m_region
+    );
+
     wl_signal_add(&xwayland_surface->events.set_geometry, &unmanaged->ml_set_geometry);
 
     struct wlr_seat* wlr_seat = unmanaged->mp_seat->mp_wlr_seat;
@@ -815,6 +910,7 @@ XWaylandUnmanaged::handle_unmap(struct wl_listener* listener, void*)
     struct wlr_seat* wlr_seat = unmanaged->mp_seat->mp_wlr_seat;
 
     wl_list_remove(&unmanaged->ml_set_geometry.link);
+    unmanaged->mp_model->spatial_index().erase(unmanaged);
 
     if (wlr_seat->keyboard_state.focused_surface == xwayland_surface->surface) {
         if (xwayland_surface->parent && xwayland_surface->parent->surface
@@ -896,6 +992,18 @@ XWaylandUnmanaged::handle_set_geometry(struct wl_listener* listener, void*)
             unmanaged->m_region.pos.y
         );
     }
+
+    unmanaged->m_region.dim = Dim{
+        .w = xwayland_surface->width,
+        .h = xwayland_surface->height,
+    };
+
+    unmanaged->mp_model->spatial_index().insert(
+        unmanaged,
+        unmanaged->mp_scene,
+        SCENE_LAYER_FREE,
+        unmanaged->m_region
+    );
 }
 
 void
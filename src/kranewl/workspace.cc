@@ -10,6 +10,18 @@
 #include <algorithm>
 #include <optional>
 
+// https://github.com/swaywm/wlroots/issues/682
+#include <pthread.h>
+#define class class_
+#define namespace namespace_
+#define static
+extern "C" {
+#include <wlr/types/wlr_scene.h>
+}
+#undef static
+#undef namespace
+#undef class
+
 Workspace::Workspace(Index index, std::string name, Context_ptr context)
     : m_index(index),
       m_name(name),
@@ -33,7 +45,11 @@ Workspace::Workspace(Index index, std::string name, Context_ptr context)
       m_free_views({}, true),
       m_iconified_views({}, true),
       m_disowned_views({}, true),
-      m_focus_follows_cursor(false)
+      m_focus_follows_cursor(false),
+      m_scene_layers({}),
+      m_scene_enabled(false),
+      m_arranged_views({}),
+      m_placements({})
 {}
 
 Workspace::~Workspace()
@@ -63,6 +79,12 @@ Workspace::set_focus_follows_cursor(bool focus_follows_cursor)
     m_focus_follows_cursor = focus_follows_cursor;
 }
 
+LayoutHandler::LayoutKind
+Workspace::layout() const
+{
+    return m_layout_handler.kind();
+}
+
 bool
 Workspace::layout_is_free() const
 {
@@ -169,6 +191,44 @@ Workspace::active() const
 }
 
 
+void
+Workspace::create_scene_layers(std::array<struct wlr_scene_node*, 8> const& scene_layers)
+{
+    TRACE();
+
+    for (std::size_t i = 0; i < scene_layers.size(); ++i) {
+        m_scene_layers[i] = &wlr_scene_tree_create(scene_layers[i])->node;
+        wlr_scene_node_set_enabled(m_scene_layers[i], m_scene_enabled);
+    }
+}
+
+struct wlr_scene_node*
+Workspace::scene_layer(SceneLayer layer) const
+{
+    return m_scene_layers[layer];
+}
+
+bool
+Workspace::scene_enabled() const
+{
+    return m_scene_enabled;
+}
+
+void
+Workspace::set_scene_enabled(bool enabled)
+{
+    TRACE();
+
+    if (enabled == m_scene_enabled)
+        return;
+
+    m_scene_enabled = enabled;
+
+    for (struct wlr_scene_node* scene_layer : m_scene_layers)
+        if (scene_layer)
+            wlr_scene_node_set_enabled(scene_layer, enabled);
+}
+
 SceneLayer
 Workspace::track_layer() const
 {
@@ -557,6 +617,32 @@ Workspace::add_view(View_ptr view)
     mp_active = view;
 }
 
+void
+Workspace::adopt_view(View_ptr view)
+{
+    TRACE();
+
+    if (m_views.contains(view))
+        return;
+
+    Cycle_ptr<View_ptr> track = m_tracks[view->scene_layer()];
+    std::optional<View_ptr> track_active = track->active_element();
+
+    m_views.insert_at_back(view);
+    track->insert_at_back(view);
+
+    // unlike add_view, the adopted view does not take over focus
+    if (track_active)
+        track->activate_element(*track_active);
+
+    if (mp_active)
+        m_views.activate_element(mp_active);
+    else {
+        m_track_layer = view->scene_layer();
+        mp_active = view;
+    }
+}
+
 void
 Workspace::remove_view(View_ptr view)
 {
@@ -566,6 +652,10 @@ Workspace::remove_view(View_ptr view)
     m_disowned_views.remove_element(view);
     m_views.remove_element(view);
     remove_view_from_track(view, view->scene_layer());
+
+    // placements outlive the view until the next arrange, which a hidden
+    // workspace only gets once it is shown again
+    forget_placement(view);
 }
 
 void
@@ -577,6 +667,7 @@ Workspace::replace_view(View_ptr view, View_ptr replacement)
         = m_views.active_element().value_or(nullptr) == view;
 
     m_views.replace_element(view, replacement);
+    forget_placement(view);
 
     if (was_active) {
         m_views.activate_element(replacement);
@@ -584,6 +675,14 @@ Workspace::replace_view(View_ptr view, View_ptr replacement)
     }
 }
 
+void
+Workspace::forget_placement(View_ptr view)
+{
+    std::erase_if(m_placements, [view](Placement const& placement) {
+        return placement.view == view;
+    });
+}
+
 void
 Workspace::view_to_icon(View_ptr view)
 {
@@ -783,35 +882,52 @@ Workspace::set_layout(LayoutHandler::LayoutKind layout)
     m_layout_handler.set_kind(layout);
 }
 
-std::vector<Placement>
+std::vector<Placement> const&
 Workspace::arrange(Region region) const
 {
     TRACE();
 
-    std::deque<View_ptr> views = m_views.as_deque();
-    std::vector<Placement> placements;
-    placements.reserve(views.size());
+    auto is_fullscreen = [](const View_ptr view) -> bool {
+        return view->fullscreen() && !view->contained();
+    };
 
-    auto fullscreen_iter = std::stable_partition(
-        views.begin(),
-        views.end(),
-        [](const View_ptr view) -> bool {
-            return view->fullscreen() && !view->contained();
-        }
-    );
+    const bool layout_free = layout_is_free();
+    auto is_free = [layout_free](const View_ptr view) -> bool {
+        return !layout_free && View::is_free(view);
+    };
 
-    auto free_iter = std::stable_partition(
-        fullscreen_iter,
-        views.end(),
-        [=,this](const View_ptr view) -> bool {
-            return !layout_is_free() && View::is_free(view);
-        }
-    );
+    auto collect = [this](auto predicate) {
+        for (View_ptr view : m_views)
+            if (predicate(view))
+                m_arranged_views.push_back(view);
+    };
+
+    m_arranged_views.clear();
+    m_placements.clear();
+
+    collect([&](const View_ptr view) {
+        return is_fullscreen(view);
+    });
+
+    const std::size_t free_index = m_arranged_views.size();
+
+    collect([&](const View_ptr view) {
+        return !is_fullscreen(view) && is_free(view);
+    });
+
+    const std::size_t tile_index = m_arranged_views.size();
+
+    collect([&](const View_ptr view) {
+        return !is_fullscreen(view) && !is_free(view);
+    });
+
+    auto fullscreen_iter = m_arranged_views.cbegin() + free_index;
+    auto free_iter = m_arranged_views.cbegin() + tile_index;
 
     std::transform(
-        views.begin(),
+        m_arranged_views.cbegin(),
         fullscreen_iter,
-        std::back_inserter(placements),
+        std::back_inserter(m_placements),
         [region](const View_ptr view) -> Placement {
             return Placement {
                 Placement::PlacementMethod::Fullscreen,
@@ -825,7 +941,7 @@ Workspace::arrange(Region region) const
     std::transform(
         fullscreen_iter,
         free_iter,
-        std::back_inserter(placements),
+        std::back_inserter(m_placements),
         [](const View_ptr view) -> Placement {
             return Placement {
                 Placement::PlacementMethod::Free,
@@ -838,15 +954,15 @@ Workspace::arrange(Region region) const
 
     m_layout_handler.arrange(
         region,
-        placements,
+        m_placements,
         free_iter,
-        views.end()
+        m_arranged_views.cend()
     );
 
     if (layout_is_single()) {
         std::for_each(
-            placements.begin(),
-            placements.end(),
+            m_placements.begin(),
+            m_placements.end(),
             [](Placement& placement) {
                 if (!placement.view->focused())
                     placement.region = std::nullopt;
@@ -854,5 +970,5 @@ Workspace::arrange(Region region) const
         );
     }
 
-    return placements;
+    return m_placements;
 }
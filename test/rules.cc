@@ -0,0 +1,84 @@
+#include <kranewl/rules.hh>
+
+#include <spdlog/spdlog.h>
+
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct Case final {
+    std::string rule;
+    std::optional<Index> to_output;
+    std::optional<Index> to_context;
+    std::optional<Index> to_workspace;
+    std::optional<unsigned> frame_rate;
+};
+
+static const std::vector<Case> cases = {
+    { "R30",        std::nullopt, std::nullopt, std::nullopt, 30 },
+    { "R144",       std::nullopt, std::nullopt, std::nullopt, 144 },
+    { "W2",         std::nullopt, std::nullopt, 2,            std::nullopt },
+    { "R30W2",      std::nullopt, std::nullopt, 2,            30 },
+    { "W2R30",      std::nullopt, std::nullopt, 2,            30 },
+    { "R3O1",       1,            std::nullopt, std::nullopt, 3 },
+    { "R60C4W7",    std::nullopt, 4,            7,            60 },
+    { "O1R24fC2",   1,            2,            std::nullopt, 24 },
+    { "R0",         std::nullopt, std::nullopt, std::nullopt, std::nullopt },
+    { "R0W3",       std::nullopt, std::nullopt, 3,            std::nullopt },
+    { "R1001",      std::nullopt, std::nullopt, std::nullopt, std::nullopt },
+    { "R99999999999", std::nullopt, std::nullopt, std::nullopt, std::nullopt },
+    { "R",          std::nullopt, std::nullopt, std::nullopt, std::nullopt },
+    { "R30:W2",     std::nullopt, std::nullopt, std::nullopt, 30 },
+};
+
+template <typename T>
+static std::string
+format_optional(std::optional<T> const& value)
+{
+    return value ? std::to_string(*value) : std::string{"none"};
+}
+
+template <typename T>
+static bool
+check(std::string const& rule, char const* field, std::optional<T> actual, std::optional<T> expected)
+{
+    if (actual == expected)
+        return true;
+
+    spdlog::error("Rule {}: {} is {}, expected {}",
+        rule,
+        field,
+        format_optional(actual),
+        format_optional(expected)
+    );
+
+    return false;
+}
+
+int
+main()
+{
+    spdlog::set_level(spdlog::level::err);
+
+    std::size_t failures = 0;
+
+    for (Case const& c : cases) {
+        Rules rules = Rules::parse_rules(c.rule, true);
+
+        bool passed = check(c.rule, "to_output", rules.to_output, c.to_output);
+        passed &= check(c.rule, "to_context", rules.to_context, c.to_context);
+        passed &= check(c.rule, "to_workspace", rules.to_workspace, c.to_workspace);
+        passed &= check(c.rule, "frame_rate", rules.frame_rate, c.frame_rate);
+
+        if (!passed)
+            ++failures;
+    }
+
+    if (failures) {
+        spdlog::error("{} of {} rules parsed incorrectly", failures, cases.size());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}